@@ -174,6 +174,20 @@ void Basic_Agent::set_internal_uptake_constants( double dt )
 	cell_source_sink_solver_temp_export2 /= ( (microenvironment->voxels(current_voxel_index)).volume ) ; 
 	// change in surrounding density 
 	
+	// multi-rate time stepping: substrate i is updated every m-th step, with time step m*dt 
+	// (see Microenvironment::substrate_time_step) 
+	if( microenvironment->multirate_time_stepping_enabled() )
+	{
+		for( unsigned int i=0; i < cell_source_sink_solver_temp1.size() ; i++ )
+		{
+			double m = microenvironment->substrate_time_step( i , 1.0 ); 
+			cell_source_sink_solver_temp1[i] *= m; 
+			cell_source_sink_solver_temp2[i] = 1.0 + m*( cell_source_sink_solver_temp2[i] - 1.0 ); 
+			cell_source_sink_solver_temp_export1[i] *= m; 
+			cell_source_sink_solver_temp_export2[i] *= m; 
+		}
+	}
+	
 	volume_is_changed = false; 
 	
 	return; 
@@ -354,6 +368,41 @@ void Basic_Agent::simulate_secretion_and_uptake( Microenvironment* pS, double dt
 		volume_is_changed = false;
 	}
 	
+	if( pS->multirate_time_stepping_enabled() || pS->quasi_steady_state_enabled() )
+	{
+		// same update as below, only for the substrates that are advanced in this step. The 
+		// quasi-steady-state solve already includes the cell terms, so those substrates only 
+		// track the amount the cell exchanges with the solved field. 
+		std::vector<double>& rho = (*pS)(current_voxel_index); 
+		double voxel_volume = pS->voxels(current_voxel_index).volume; 
+		for( unsigned int i=0; i < rho.size() ; i++ )
+		{
+			if( pS->substrate_is_quasi_steady(i) )
+			{
+				if( default_microenvironment_options.track_internalized_substrates_in_each_agent == true )
+				{
+					double change = dt * ( volume * ( (*secretion_rates)[i] * ( (*saturation_densities)[i] - rho[i] ) 
+						- (*uptake_rates)[i] * rho[i] ) + (*net_export_rates)[i] ); 
+					(*internalized_substrates)[i] -= change; 
+				}
+				continue; 
+			}
+			if( !pS->substrate_is_due(i) )
+			{ continue; }
+			if( default_microenvironment_options.track_internalized_substrates_in_each_agent == true )
+			{
+				double change = ( ( 1.0 - cell_source_sink_solver_temp2[i] ) * rho[i] + cell_source_sink_solver_temp1[i] ) 
+					/ cell_source_sink_solver_temp2[i] * voxel_volume; 
+				(*internalized_substrates)[i] -= change; 
+				(*internalized_substrates)[i] -= cell_source_sink_solver_temp_export1[i]; 
+			}
+			rho[i] += cell_source_sink_solver_temp1[i]; 
+			rho[i] /= cell_source_sink_solver_temp2[i]; 
+			rho[i] += cell_source_sink_solver_temp_export2[i]; 
+		}
+		return; 
+	}
+	
 	if( default_microenvironment_options.track_internalized_substrates_in_each_agent == true )
 	{
 		total_extracellular_substrate_change.assign( total_extracellular_substrate_change.size() , 1.0 ); // 1
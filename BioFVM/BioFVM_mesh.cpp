@@ -573,6 +573,7 @@ Cartesian_Mesh::Cartesian_Mesh( int xnodes, int ynodes, int znodes )
 
 void Cartesian_Mesh::create_moore_neighborhood()
 {
+	moore_connected_voxel_indices.clear(); // in case the mesh is resized 
 	moore_connected_voxel_indices.resize( voxels.size() );
 	for( unsigned int j=0 ; j < y_coordinates.size() ; j++ )
 	{
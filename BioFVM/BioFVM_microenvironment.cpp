@@ -114,6 +114,26 @@ Microenvironment::Microenvironment()
 	bulk_source_sink_solver_setup_done = false; 
 	thomas_setup_done = false; 
 	diffusion_solver_setup_done = false; 
+	
+	contiguous_density_storage = false; 
+	contiguous_density_layout = substrate_major_density_layout; 
+	contiguous_density_stride = 0; 
+	vectorized_thomas_sweeps = false; 
+	thomas_block_size = 64; 
+	
+	dirichlet_list_up_to_date = false; 
+	dirichlet_packed_stride = 0; 
+	
+	fused_bulk_source_sink = false; 
+	bulk_source_sink_pending = false; 
+	bulk_source_sink_dt = 0.0; 
+	fused_bulk_coefficients_up_to_date = false; 
+	bulk_rates_are_cached = false; 
+	cached_bulk_supply_rate_function = NULL; 
+	cached_bulk_supply_target_densities_function = NULL; 
+	cached_bulk_uptake_rate_function = NULL; 
+	
+	deterministic_cell_sources_and_sinks = false; 
 
 	diffusion_decay_solver = empty_diffusion_solver;
 	diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_LOD_3D; 
@@ -133,7 +153,10 @@ Microenvironment::Microenvironment()
 		gradient_vectors[k].resize( 1 ); 
 		(gradient_vectors[k])[0].resize( 3, 0.0 );
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 
+	gradient_storage_stride = 0; 
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 
 	bulk_supply_rate_function = zero_function; 
 	bulk_supply_target_densities_function = zero_function; 
@@ -145,6 +168,14 @@ Microenvironment::Microenvironment()
 	diffusion_coefficients.assign( number_of_densities() , 0.0 ); 
 	decay_rates.assign( number_of_densities() , 0.0 ); 
 	
+	diffusion_time_step_multiples.assign( number_of_densities() , 1 ); 
+	diffusion_step_count = 0; 
+	
+	quasi_steady_state_intervals.assign( number_of_densities() , 0 ); 
+	quasi_steady_state_source_thresholds.assign( number_of_densities() , 0.0 ); 
+	quasi_steady_state_tolerance = 1e-8; 
+	quasi_steady_state_max_iterations = 1000; 
+	
 	one_half = one; 
 	one_half *= 0.5; 
 	
@@ -155,6 +186,7 @@ Microenvironment::Microenvironment()
 	dirichlet_activation_vector.assign( 1 , false );
 	
 	dirichlet_activation_vectors.assign( 1 , dirichlet_activation_vector ); 
+	dirichlet_list_up_to_date = false; 
 	
 	default_microenvironment_options.Dirichlet_all.assign( 1 , true ); 
 	default_microenvironment_options.Dirichlet_xmin.assign( 1 , false ); 
@@ -188,12 +220,8 @@ Microenvironment::Microenvironment(std::string name)
 void Microenvironment::add_dirichlet_node( int voxel_index, std::vector<double>& value )
 {
 	mesh.voxels[voxel_index].is_Dirichlet=true;
-	/*
-	dirichlet_indices.push_back( voxel_index );
-	dirichlet_value_vectors.push_back( value ); 
-	*/
-	
 	dirichlet_value_vectors[voxel_index] = value; // .assign( mesh.voxels.size(), one ); 
+	add_to_dirichlet_list( voxel_index ); 
 	
 	return; 
 }
@@ -202,6 +230,7 @@ void Microenvironment::update_dirichlet_node( int voxel_index , std::vector<doub
 {
 	mesh.voxels[voxel_index].is_Dirichlet = true; 
 	dirichlet_value_vectors[voxel_index] = new_value; 
+	add_to_dirichlet_list( voxel_index ); 
 	
 	return; 
 }
@@ -212,6 +241,7 @@ void Microenvironment::update_dirichlet_node( int voxel_index , int substrate_in
 	dirichlet_value_vectors[voxel_index][substrate_index] = new_value; 
 	
 	dirichlet_activation_vectors[voxel_index][substrate_index] = true; 
+	add_to_dirichlet_list( voxel_index ); 
 
 	return; 
 }
@@ -219,15 +249,94 @@ void Microenvironment::update_dirichlet_node( int voxel_index , int substrate_in
 void Microenvironment::remove_dirichlet_node( int voxel_index )
 {
 	mesh.voxels[voxel_index].is_Dirichlet = false; 
+	remove_from_dirichlet_list( voxel_index ); 
 	
 	return; 
 }
 
 bool& Microenvironment::is_dirichlet_node( int voxel_index )
 {
+	// the caller may change the flag through the reference 
+	dirichlet_list_up_to_date = false; 
 	return mesh.voxels[voxel_index].is_Dirichlet; 
 }
 
+void Microenvironment::rebuild_dirichlet_list( void )
+{
+	fused_bulk_coefficients_up_to_date = false; 
+	dirichlet_indices.clear(); 
+	dirichlet_list_position.assign( mesh.voxels.size() , -1 ); 
+	dirichlet_packed_stride = number_of_densities(); 
+	dirichlet_packed_values.clear(); 
+	dirichlet_packed_activation.clear(); 
+	dirichlet_list_up_to_date = true; 
+	
+	for( unsigned int i=0 ; i < mesh.voxels.size() ; i++ )
+	{
+		if( mesh.voxels[i].is_Dirichlet == true )
+		{ add_to_dirichlet_list( i ); }
+	}
+	return; 
+}
+
+void Microenvironment::add_to_dirichlet_list( int voxel_index )
+{
+	if( dirichlet_list_up_to_date == false )
+	{ return; } // rebuilt from the is_Dirichlet flags before the next use 
+	
+	if( dirichlet_list_position[voxel_index] < 0 )
+	{
+		dirichlet_list_position[voxel_index] = dirichlet_indices.size(); 
+		dirichlet_indices.push_back( voxel_index ); 
+		dirichlet_packed_values.resize( dirichlet_packed_values.size() + dirichlet_packed_stride , 0.0 ); 
+		dirichlet_packed_activation.resize( dirichlet_packed_activation.size() + dirichlet_packed_stride , false ); 
+	}
+	pack_dirichlet_node( voxel_index ); 
+	return; 
+}
+
+void Microenvironment::pack_dirichlet_node( int voxel_index )
+{
+	fused_bulk_coefficients_up_to_date = false; 
+	if( dirichlet_list_up_to_date == false || dirichlet_list_position[voxel_index] < 0 )
+	{ return; }
+	
+	unsigned int start = dirichlet_list_position[voxel_index] * dirichlet_packed_stride; 
+	for( unsigned int j=0; j < dirichlet_packed_stride ; j++ )
+	{
+		bool active = j < dirichlet_value_vectors[voxel_index].size() && dirichlet_activation_vectors[voxel_index][j]; 
+		dirichlet_packed_activation[start+j] = active; 
+		dirichlet_packed_values[start+j] = active ? dirichlet_value_vectors[voxel_index][j] : 0.0; 
+	}
+	return; 
+}
+
+void Microenvironment::remove_from_dirichlet_list( int voxel_index )
+{
+	fused_bulk_coefficients_up_to_date = false; 
+	if( dirichlet_list_up_to_date == false || dirichlet_list_position[voxel_index] < 0 )
+	{ return; }
+	
+	// swap with the last entry, then shorten the list 
+	unsigned int m = dirichlet_list_position[voxel_index]; 
+	unsigned int last = dirichlet_indices.size()-1; 
+	if( m != last )
+	{
+		dirichlet_indices[m] = dirichlet_indices[last]; 
+		dirichlet_list_position[ dirichlet_indices[m] ] = m; 
+		for( unsigned int j=0; j < dirichlet_packed_stride ; j++ )
+		{
+			dirichlet_packed_values[m*dirichlet_packed_stride+j] = dirichlet_packed_values[last*dirichlet_packed_stride+j]; 
+			dirichlet_packed_activation[m*dirichlet_packed_stride+j] = dirichlet_packed_activation[last*dirichlet_packed_stride+j]; 
+		}
+	}
+	dirichlet_indices.pop_back(); 
+	dirichlet_packed_values.resize( dirichlet_indices.size()*dirichlet_packed_stride ); 
+	dirichlet_packed_activation.resize( dirichlet_indices.size()*dirichlet_packed_stride ); 
+	dirichlet_list_position[voxel_index] = -1; 
+	return; 
+}
+
 void Microenvironment::set_only_substrate_dirichlet_activation( int substrate_index , bool new_value )
 {
 	dirichlet_activation_vector[substrate_index] = new_value; 
@@ -240,6 +349,8 @@ void Microenvironment::set_substrate_dirichlet_activation( int substrate_index ,
 	
 	for( int n = 0 ; n < mesh.voxels.size() ; n++ )
 	{ dirichlet_activation_vectors[n][substrate_index] = new_value; }
+	for( unsigned int m = 0 ; m < dirichlet_indices.size() ; m++ )
+	{ pack_dirichlet_node( dirichlet_indices[m] ); }
 	
 	return; 
 }
@@ -247,6 +358,7 @@ void Microenvironment::set_substrate_dirichlet_activation( int substrate_index ,
 void Microenvironment::set_substrate_dirichlet_activation( int index, std::vector<bool>& new_value )
 {
 	dirichlet_activation_vectors[index] = new_value; 
+	pack_dirichlet_node( index ); 
 	return; 
 }
 
@@ -267,6 +379,7 @@ double Microenvironment::get_substrate_dirichlet_value( int substrate_index, int
 void Microenvironment::set_substrate_dirichlet_activation( int substrate_index , int index, bool new_value )
 {
 	dirichlet_activation_vectors[index][substrate_index] = new_value; 
+	pack_dirichlet_node( index ); 
 	return; 
 }
 
@@ -276,30 +389,37 @@ bool Microenvironment::get_substrate_dirichlet_activation( int substrate_index,
 
 void Microenvironment::apply_dirichlet_conditions( void )
 {
-	/*
+	if( dirichlet_list_up_to_date == false )
+	{ rebuild_dirichlet_list(); }
+	
 	#pragma omp parallel for 
-	for( unsigned int i=0 ; i < dirichlet_indices.size() ; i++ )
-	{ density_vector( dirichlet_indices[i] ) = dirichlet_value_vectors[i]; }
-	*/
-
-	// #pragma omp parallel for 
-	for( unsigned int i=0 ; i < mesh.voxels.size() ;i++ )
+	for( int m=0 ; m < (int) dirichlet_indices.size() ; m++ )
 	{
-		/*
-		if( mesh.voxels[i].is_Dirichlet == true )
-		{ density_vector(i) = dirichlet_value_vectors[i]; }
-		*/
-		if( mesh.voxels[i].is_Dirichlet == true )
+		std::vector<double>& density = density_vector( dirichlet_indices[m] ); 
+		unsigned int start = m*dirichlet_packed_stride; 
+		for( unsigned int j=0; j < dirichlet_packed_stride ; j++ )
 		{
-			for( unsigned int j=0; j < dirichlet_value_vectors[i].size(); j++ )
-			{
-				// if( dirichlet_activation_vector[j] == true )
-				if( dirichlet_activation_vectors[i][j] == true )
-				{
-					density_vector(i)[j] = dirichlet_value_vectors[i][j]; 
-				}
-			}
+			if( dirichlet_packed_activation[start+j] == true )
+			{ density[j] = dirichlet_packed_values[start+j]; }
+		}
+	}
+	return; 
+}
+
+void Microenvironment::apply_dirichlet_conditions_to_contiguous_storage( void )
+{
+	if( dirichlet_list_up_to_date == false )
+	{ rebuild_dirichlet_list(); }
 	
+	double* pData = contiguous_densities.data(); 
+	#pragma omp parallel for 
+	for( int m=0 ; m < (int) dirichlet_indices.size() ; m++ )
+	{
+		unsigned int start = m*dirichlet_packed_stride; 
+		for( unsigned int j=0; j < dirichlet_packed_stride ; j++ )
+		{
+			if( dirichlet_packed_activation[start+j] == true )
+			{ pData[ contiguous_density_index( dirichlet_indices[m] ,j) ] = dirichlet_packed_values[start+j]; }
 		}
 	}
 	return; 
@@ -328,11 +448,14 @@ void Microenvironment::resize_voxels( int new_number_of_voxes )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 	
 	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
 
 	dirichlet_activation_vectors.assign( mesh.voxels.size() , dirichlet_activation_vector ); 
+	dirichlet_list_up_to_date = false; 
 	
 	return; 
 }
@@ -354,11 +477,14 @@ void Microenvironment::resize_space( int x_nodes, int y_nodes, int z_nodes )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 	
 	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
 	
 	dirichlet_activation_vectors.assign( mesh.voxels.size() , dirichlet_activation_vector ); 
+	dirichlet_list_up_to_date = false; 
 	
 	return;  
 }
@@ -379,11 +505,14 @@ void Microenvironment::resize_space( double x_start, double x_end, double y_star
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 
 	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
 	
 	dirichlet_activation_vectors.assign( mesh.voxels.size() , dirichlet_activation_vector ); 	
+	dirichlet_list_up_to_date = false; 
 	
 	return;  
 }
@@ -404,11 +533,14 @@ void Microenvironment::resize_space( double x_start, double x_end, double y_star
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 	
 	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
 
 	dirichlet_activation_vectors.assign( mesh.voxels.size() , dirichlet_activation_vector ); 
+	dirichlet_list_up_to_date = false; 
 	
 	return;  
 }
@@ -434,10 +566,15 @@ void Microenvironment::resize_densities( int new_size )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 	
 	diffusion_coefficients.assign( new_size , 0.0 ); 
 	decay_rates.assign( new_size , 0.0 ); 
+	diffusion_time_step_multiples.assign( new_size , 1 ); 
+	quasi_steady_state_intervals.assign( new_size , 0 ); 
+	quasi_steady_state_source_thresholds.assign( new_size , 0.0 ); 
 
 	density_names.assign( new_size, "unnamed" ); 
 	density_units.assign( new_size , "none" ); 
@@ -452,6 +589,7 @@ void Microenvironment::resize_densities( int new_size )
 	dirichlet_activation_vector.assign( new_size, false );
 
 	dirichlet_activation_vectors.assign( mesh.voxels.size(), dirichlet_activation_vector ); 
+	dirichlet_list_up_to_date = false; 
 
 	default_microenvironment_options.Dirichlet_condition_vector.assign( new_size , 1.0 );  
 	default_microenvironment_options.Dirichlet_activation_vector.assign( new_size, false );
@@ -511,6 +649,9 @@ void Microenvironment::add_density( std::string name , std::string units, double
 	// update coefficients 
 	diffusion_coefficients.push_back( diffusion_constant ); 
 	decay_rates.push_back( decay_rate ); 
+	diffusion_time_step_multiples.push_back( 1 ); 
+	quasi_steady_state_intervals.push_back( 0 ); 
+	quasi_steady_state_source_thresholds.push_back( 0.0 ); 
 	
 	// update sources and such 
 	for( unsigned int i=0; i < temporary_density_vectors1.size() ; i++ )
@@ -528,7 +669,9 @@ void Microenvironment::add_density( std::string name , std::string units, double
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.resize( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.resize( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
+	gradient_substrate_mask_up_to_date = false; 
 
 	one_half = one; 
 	one_half *= 0.5; 
@@ -539,6 +682,7 @@ void Microenvironment::add_density( std::string name , std::string units, double
 	dirichlet_value_vectors.assign( mesh.voxels.size(), one ); 
 	dirichlet_activation_vector.push_back( false ); 
 	dirichlet_activation_vectors.assign( mesh.voxels.size(), dirichlet_activation_vector ); 
+	dirichlet_list_up_to_date = false; 
 	
 	// fix in PhysiCell preview November 2017 
 	default_microenvironment_options.Dirichlet_condition_vector.push_back( 1.0 ); // = one; 
@@ -642,10 +786,157 @@ std::vector<double>& Microenvironment::density_vector( int i, int j )
 std::vector<double>& Microenvironment::density_vector( int n )
 { return (*p_density_vectors)[ n ]; }
 
+void Microenvironment::enable_contiguous_density_storage( int layout )
+{
+	if( layout != voxel_major_density_layout && layout != substrate_major_density_layout )
+	{
+		std::cout << "Error: unknown contiguous density layout " << layout << ". Using substrate-major layout." << std::endl; 
+		layout = substrate_major_density_layout; 
+	}
+	contiguous_density_storage = true; 
+	contiguous_density_layout = layout; 
+	contiguous_density_stride = 0; // forces a resize on the next copy 
+	return; 
+}
+
+void Microenvironment::disable_contiguous_density_storage( void )
+{
+	contiguous_density_storage = false; 
+	contiguous_density_stride = 0; 
+	aligned_double_vector().swap( contiguous_densities ); 
+	return; 
+}
+
+bool Microenvironment::contiguous_density_storage_enabled( void )
+{ return contiguous_density_storage; }
+
+int Microenvironment::density_storage_layout( void )
+{ return contiguous_density_layout; }
+
+unsigned int Microenvironment::density_storage_stride( void )
+{ return contiguous_density_stride; }
+
+void Microenvironment::enable_vectorized_thomas_sweeps( bool new_value )
+{
+	vectorized_thomas_sweeps = new_value; 
+	if( new_value == true && 
+		( contiguous_density_storage == false || contiguous_density_layout != substrate_major_density_layout ) )
+	{ enable_contiguous_density_storage( substrate_major_density_layout ); }
+	return; 
+}
+
+bool Microenvironment::vectorized_thomas_sweeps_enabled( void )
+{ return vectorized_thomas_sweeps; }
+
+void Microenvironment::set_thomas_sweep_block_size( int new_value )
+{
+	if( new_value < 0 )
+	{ new_value = 0; }
+	thomas_block_size = new_value; 
+	return; 
+}
+
+int Microenvironment::thomas_sweep_block_size( void )
+{ return thomas_block_size; }
+
+double* Microenvironment::contiguous_density_data( void )
+{ return contiguous_densities.data(); }
+
+unsigned int Microenvironment::contiguous_density_index( int n , int q )
+{
+	if( contiguous_density_layout == voxel_major_density_layout )
+	{ return n*contiguous_density_stride + q; }
+	return q*contiguous_density_stride + n; 
+}
+
+void Microenvironment::resize_contiguous_storage( void )
+{
+	unsigned int number_of_voxels = mesh.voxels.size(); 
+	unsigned int number_of_substrates = number_of_densities(); 
+	
+	unsigned int stride = number_of_substrates; 
+	unsigned int size = number_of_voxels * number_of_substrates; 
+	if( contiguous_density_layout == substrate_major_density_layout )
+	{
+		// pad each substrate so that it starts on an aligned boundary 
+		static unsigned int doubles_per_line = BioFVM_buffer_alignment / sizeof(double); 
+		stride = number_of_voxels + ( doubles_per_line - number_of_voxels % doubles_per_line ) % doubles_per_line; 
+		size = stride * number_of_substrates; 
+	}
+	if( stride != contiguous_density_stride || size != contiguous_densities.size() )
+	{
+		contiguous_densities.assign( size , 0.0 ); 
+		contiguous_density_stride = stride; 
+	}
+	return; 
+}
+
+void Microenvironment::copy_densities_to_contiguous_storage( void )
+{
+	unsigned int number_of_voxels = mesh.voxels.size(); 
+	unsigned int number_of_substrates = number_of_densities(); 
+	
+	resize_contiguous_storage(); 
+	unsigned int stride = contiguous_density_stride; 
+	
+	double* pData = contiguous_densities.data(); 
+	if( contiguous_density_layout == voxel_major_density_layout )
+	{
+		#pragma omp parallel for 
+		for( unsigned int n=0; n < number_of_voxels ; n++ )
+		{
+			std::memcpy( pData + n*stride , (*p_density_vectors)[n].data() , number_of_substrates*sizeof(double) ); 
+		}
+	}
+	else
+	{
+		#pragma omp parallel for 
+		for( unsigned int n=0; n < number_of_voxels ; n++ )
+		{
+			const double* pVoxel = (*p_density_vectors)[n].data(); 
+			for( unsigned int q=0; q < number_of_substrates ; q++ )
+			{ pData[ q*stride + n ] = pVoxel[q]; }
+		}
+	}
+	return; 
+}
+
+void Microenvironment::copy_densities_from_contiguous_storage( void )
+{
+	unsigned int number_of_voxels = mesh.voxels.size(); 
+	unsigned int number_of_substrates = number_of_densities(); 
+	unsigned int stride = contiguous_density_stride; 
+
+	const double* pData = contiguous_densities.data(); 
+	if( contiguous_density_layout == voxel_major_density_layout )
+	{
+		#pragma omp parallel for 
+		for( unsigned int n=0; n < number_of_voxels ; n++ )
+		{
+			std::memcpy( (*p_density_vectors)[n].data() , pData + n*stride , number_of_substrates*sizeof(double) ); 
+		}
+	}
+	else
+	{
+		#pragma omp parallel for 
+		for( unsigned int n=0; n < number_of_voxels ; n++ )
+		{
+			double* pVoxel = (*p_density_vectors)[n].data(); 
+			for( unsigned int q=0; q < number_of_substrates ; q++ )
+			{ pVoxel[q] = pData[ q*stride + n ]; }
+		}
+	}
+	return; 
+}
+
 void Microenvironment::simulate_diffusion_decay( double dt )
 {
+	diffusion_step_count++; 
 	if( diffusion_decay_solver )
-	{ diffusion_decay_solver( *this, dt ); }
+	{
+		diffusion_decay_solver( *this, dt ); 
+		simulate_quasi_steady_state_substrates(); 
+	}
 	else
 	{
 		std::cout << "Warning: diffusion-reaction-source/sink solver not set for Microenvironment object at " << this << ". Nothing happened!" << std::endl; 
@@ -655,8 +946,171 @@ void Microenvironment::simulate_diffusion_decay( double dt )
 	return; 
 }
 
+void Microenvironment::set_diffusion_time_step_multiple( int substrate_index , int multiple )
+{
+	if( multiple < 1 )
+	{
+		std::cout << "Error: the time step multiple for " << density_names[substrate_index] 
+			<< " must be a positive integer. Using 1." << std::endl; 
+		multiple = 1; 
+	}
+	diffusion_time_step_multiples[substrate_index] = multiple; 
+	diffusion_solver_setup_done = false; // recompute the solver coefficients 
+	fused_bulk_coefficients_up_to_date = false; 
+	
+	// and the agents' uptake constants, which are scaled to the multiple 
+	for( unsigned int i=0; i < all_basic_agents.size() ; i++ )
+	{
+		if( all_basic_agents[i]->get_microenvironment() == this )
+		{ all_basic_agents[i]->set_volume_is_changed( true ); }
+	}
+	return; 
+}
+
+bool Microenvironment::multirate_time_stepping_enabled( void )
+{
+	for( unsigned int q=0; q < diffusion_time_step_multiples.size() ; q++ )
+	{
+		if( diffusion_time_step_multiples[q] > 1 )
+		{ return true; }
+	}
+	return false; 
+}
+
+// substrate q is due in every m-th diffusion step (m = diffusion_time_step_multiples[q]), 
+// starting with step m, and then advances by the time accumulated since its last due step 
+bool Microenvironment::substrate_is_due( int substrate_index )
+{ return diffusion_step_count % diffusion_time_step_multiples[substrate_index] == 0; }
+
+double Microenvironment::substrate_time_step( int substrate_index , double dt )
+{ return dt * diffusion_time_step_multiples[substrate_index]; }
+
+std::vector<double> Microenvironment::substrate_time_steps( double dt )
+{
+	std::vector<double> out( number_of_densities() , dt ); 
+	for( unsigned int q=0; q < number_of_densities() ; q++ )
+	{ out[q] = substrate_time_step( q , dt ); }
+	return out; 
+}
+
+void Microenvironment::simulate_quasi_steady_state_substrates( void )
+{
+	if( quasi_steady_state_step_counts.size() != number_of_densities() )
+	{
+		// solve at the first opportunity
+		quasi_steady_state_step_counts.assign( number_of_densities() , 0 ); 
+		quasi_steady_state_source_totals.assign( number_of_densities() , -1.0 ); 
+	}
+	
+	for( unsigned int q=0; q < number_of_densities() ; q++ )
+	{
+		if( quasi_steady_state_intervals[q] <= 0 )
+		{ continue; }
+		
+		quasi_steady_state_step_counts[q]++; 
+		bool solve = quasi_steady_state_source_totals[q] < 0.0 || 
+			quasi_steady_state_step_counts[q] >= quasi_steady_state_intervals[q]; 
+		if( solve == false && quasi_steady_state_source_thresholds[q] > 0.0 )
+		{
+			// summed by the last cell source/sink loop, if one has run 
+			double total; 
+			if( quasi_steady_state_current_source_totals.size() == number_of_densities() )
+			{ total = quasi_steady_state_current_source_totals[q]; }
+			else
+			{ total = quasi_steady_state_source_total( *this , q ); }
+			double change = fabs( total - quasi_steady_state_source_totals[q] ); 
+			solve = change > quasi_steady_state_source_thresholds[q] * quasi_steady_state_source_totals[q]; 
+		}
+		
+		if( solve )
+		{
+			quasi_steady_state_solver( *this , q ); 
+			quasi_steady_state_step_counts[q] = 0; 
+		}
+	}
+	return; 
+}
+
+bool Microenvironment::quasi_steady_state_enabled( void )
+{
+	for( unsigned int q=0; q < quasi_steady_state_intervals.size() ; q++ )
+	{
+		if( quasi_steady_state_intervals[q] > 0 )
+		{ return true; }
+	}
+	return false; 
+}
+
+bool Microenvironment::substrate_is_quasi_steady( int substrate_index )
+{ return quasi_steady_state_intervals[substrate_index] > 0; }
+
+bool Microenvironment::substrate_is_advanced( int substrate_index )
+{ return substrate_is_due( substrate_index ) && !substrate_is_quasi_steady( substrate_index ); }
+
+bool Microenvironment::quasi_steady_state_source_tracking_enabled( void )
+{
+	for( unsigned int q=0; q < quasi_steady_state_intervals.size() ; q++ )
+	{
+		if( quasi_steady_state_intervals[q] > 0 && quasi_steady_state_source_thresholds[q] > 0.0 )
+		{ return true; }
+	}
+	return false; 
+}
+
+void Microenvironment::reset_quasi_steady_state_sources( void )
+{
+	quasi_steady_state_current_source_totals.assign( number_of_densities() , 0.0 ); 
+	return; 
+}
+
+void Microenvironment::add_quasi_steady_state_sources( Basic_Agent* pA , std::vector<double>& totals )
+{
+	// same strength as quasi_steady_state_source_total 
+	if( pA->is_active == false || pA->get_microenvironment() != this || pA->get_current_voxel_index() < 0 )
+	{ return; }
+	if( totals.size() != number_of_densities() )
+	{ totals.assign( number_of_densities() , 0.0 ); }
+	double volume = pA->get_total_volume(); 
+	for( unsigned int q=0; q < number_of_densities() ; q++ )
+	{
+		if( quasi_steady_state_intervals[q] <= 0 || quasi_steady_state_source_thresholds[q] <= 0.0 )
+		{ continue; }
+		totals[q] += volume * ( (*pA->secretion_rates)[q] * ( 1.0 + (*pA->saturation_densities)[q] ) + (*pA->uptake_rates)[q] ) 
+			+ fabs( (*pA->net_export_rates)[q] ); 
+	}
+	return; 
+}
+
+void Microenvironment::merge_quasi_steady_state_sources( const std::vector<double>& totals )
+{
+	if( totals.size() != quasi_steady_state_current_source_totals.size() )
+	{ return; }
+	#pragma omp critical(quasi_steady_state_sources)
+	{
+		for( unsigned int q=0; q < totals.size() ; q++ )
+		{ quasi_steady_state_current_source_totals[q] += totals[q]; }
+	}
+	return; 
+}
+
 void Microenvironment::auto_choose_diffusion_decay_solver( void )
 {
+	// quasi-steady-state substrates are solved on the stencil of the LOD solvers, whose 
+	// sweeps then skip them 
+	if( quasi_steady_state_enabled() )
+	{
+		if( mesh.regular_mesh == true && mesh.Cartesian_mesh == true )
+		{
+			if( mesh.z_coordinates.size() == 1 )
+			{ diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_LOD_2D; }
+			else
+			{ diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_LOD_3D; }
+			return; 
+		}
+		std::cout << "Warning: quasi-steady-state substrates need a regular Cartesian mesh. Solving them as transient." << std::endl; 
+		quasi_steady_state_intervals.assign( number_of_densities() , 0 ); 
+	}
+	
 	// set the safest choice 
 	diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_explicit; 
 
@@ -692,6 +1146,10 @@ void Microenvironment::display_information( std::ostream& os )
 		else
 		{ os << "false"; }
 		os << ")" << std::endl; 
+		if( diffusion_time_step_multiples[i] > 1 )
+		{ os << "     time step: every " << diffusion_time_step_multiples[i] << " diffusion steps" << std::endl; }
+		if( quasi_steady_state_intervals[i] > 0 )
+		{ os << "     quasi-steady state: solved every " << quasi_steady_state_intervals[i] << " diffusion steps" << std::endl; }
 	}
 	os << std::endl; 
 	
@@ -745,6 +1203,49 @@ void Microenvironment::simulate_bulk_sources_and_sinks( double dt )
 		bulk_source_sink_solver_setup_done = true; 
 	}
 	
+	// the stock (zero) rates leave the densities unchanged 
+	void (*zero_rates)(Microenvironment*,int,std::vector<double>*) = zero_function; 
+	if( bulk_supply_rate_function == zero_rates && bulk_uptake_rate_function == zero_rates )
+	{ return; }
+	
+	if( fused_bulk_source_sink && bulk_source_sink_can_be_fused() )
+	{
+		// applied in the first sweep of the next diffusion solve 
+		bulk_source_sink_pending = true; 
+		if( bulk_source_sink_dt != dt )
+		{ fused_bulk_coefficients_up_to_date = false; }
+		bulk_source_sink_dt = dt; 
+		return; 
+	}
+	
+	if( multirate_time_stepping_enabled() || quasi_steady_state_enabled() )
+	{
+		// only update the substrates that are due, each with its own time step 
+		// (quasi-steady substrates: the solve includes the bulk terms) 
+		std::vector<double> substrate_dt = substrate_time_steps( dt ); 
+		std::vector<char> due( number_of_densities() , 0 ); 
+		for( unsigned int q=0; q < number_of_densities() ; q++ )
+		{ due[q] = substrate_is_advanced( q ); }
+		
+		#pragma omp parallel for
+		for( unsigned int i=0; i < mesh.voxels.size() ; i++ )
+		{
+			bulk_supply_rate_function( this,i, &bulk_source_sink_solver_temp1[i] ); // temp1 = S
+			bulk_supply_target_densities_function( this,i, &bulk_source_sink_solver_temp2[i]); // temp2 = T
+			bulk_uptake_rate_function( this,i, &bulk_source_sink_solver_temp3[i] ); // temp3 = U
+			
+			for( unsigned int q=0; q < number_of_densities() ; q++ )
+			{
+				if( !due[q] )
+				{ continue; }
+				double S = bulk_source_sink_solver_temp1[i][q]; 
+				(*p_density_vectors)[i][q] += substrate_dt[q] * ( S * bulk_source_sink_solver_temp2[i][q] ); 
+				(*p_density_vectors)[i][q] /= ( bulk_source_sink_solver_temp3[i][q] + S ) * substrate_dt[q] + 1.0; 
+			}
+		}
+		return; 
+	}
+	
 	#pragma omp parallel for
 	for( unsigned int i=0; i < mesh.voxels.size() ; i++ )
 	{
@@ -765,12 +1266,174 @@ void Microenvironment::simulate_bulk_sources_and_sinks( double dt )
 	return; 
 }
 
+void Microenvironment::enable_fused_bulk_source_sink( bool new_value )
+{
+	fused_bulk_source_sink = new_value; 
+	bulk_source_sink_pending = false; 
+	fused_bulk_coefficients_up_to_date = false; 
+	return; 
+}
+
+bool Microenvironment::fused_bulk_source_sink_enabled( void )
+{ return fused_bulk_source_sink; }
+
+bool Microenvironment::bulk_source_sink_can_be_fused( void )
+{
+	// the fused coefficients are cached, so only constant rates: the stock rate functions, 
+	// or rates that the user cached with update_rates(). Only the LOD solvers apply them. 
+	if( bulk_rates_cached() == false )
+	{
+		void (*zero_rates)(Microenvironment*,int,std::vector<double>*) = zero_function; 
+		void (*one_rates)(Microenvironment*,int,std::vector<double>*) = one_function; 
+		if( bulk_supply_rate_function != zero_rates && bulk_supply_rate_function != one_rates )
+		{ return false; }
+		if( bulk_supply_target_densities_function != zero_rates && bulk_supply_target_densities_function != one_rates )
+		{ return false; }
+		if( bulk_uptake_rate_function != zero_rates && bulk_uptake_rate_function != one_rates )
+		{ return false; }
+	}
+	return diffusion_decay_solver == diffusion_decay_solver__constant_coefficients_LOD_3D || 
+		diffusion_decay_solver == diffusion_decay_solver__constant_coefficients_LOD_2D; 
+}
+
+void Microenvironment::update_fused_bulk_coefficients( void )
+{
+	if( dirichlet_list_up_to_date == false )
+	{ rebuild_dirichlet_list(); }
+	if( fused_bulk_coefficients_up_to_date && fused_bulk_source.size() == contiguous_densities.size() )
+	{ return; }
+	if( supply_rates.size() != number_of_voxels() || uptake_rates.size() != number_of_voxels() || 
+		supply_rates[0].size() != number_of_densities() )
+	{ update_rates(); }
+	
+	// same arithmetic as simulate_bulk_sources_and_sinks 
+	std::vector<double> substrate_dt = substrate_time_steps( bulk_source_sink_dt ); 
+	fused_bulk_source.assign( contiguous_densities.size() , 0.0 ); 
+	fused_bulk_denominator.assign( contiguous_densities.size() , 1.0 ); 
+	#pragma omp parallel for 
+	for( int n=0; n < (int) number_of_voxels() ; n++ )
+	{
+		for( unsigned int q=0; q < number_of_densities() ; q++ )
+		{
+			unsigned int index = contiguous_density_index( n , q ); 
+			fused_bulk_source[index] = substrate_dt[q] * supply_target_densities_times_supply_rates[n][q]; 
+			fused_bulk_denominator[index] = ( uptake_rates[n][q] + supply_rates[n][q] ) * substrate_dt[q] + 1.0; 
+		}
+	}
+	
+	// Dirichlet values win: no update there 
+	for( unsigned int m=0; m < dirichlet_indices.size() ; m++ )
+	{
+		for( unsigned int q=0; q < dirichlet_packed_stride ; q++ )
+		{
+			if( dirichlet_packed_activation[m*dirichlet_packed_stride+q] == true )
+			{
+				unsigned int index = contiguous_density_index( dirichlet_indices[m] , q ); 
+				fused_bulk_source[index] = 0.0; 
+				fused_bulk_denominator[index] = 1.0; 
+			}
+		}
+	}
+	fused_bulk_coefficients_up_to_date = true; 
+	return; 
+}
+
+void Microenvironment::enable_deterministic_cell_sources_and_sinks( bool new_value )
+{
+	deterministic_cell_sources_and_sinks = new_value; 
+	return; 
+}
+
+bool Microenvironment::deterministic_cell_sources_and_sinks_enabled( void )
+{ return deterministic_cell_sources_and_sinks; }
+
+void Microenvironment::bin_agents_by_voxel( std::vector<Basic_Agent*>& basic_agent_list )
+{
+	int number_of_mesh_voxels = mesh.voxels.size(); 
+	
+	// count the agents per voxel; after the prefix sum, voxel_end[n] is where voxel n starts 
+	std::vector<int> voxel_end( number_of_mesh_voxels+1 , 0 ); 
+	agents_without_voxel.clear(); 
+	for( unsigned int i=0; i < basic_agent_list.size() ; i++ )
+	{
+		int n = basic_agent_list[i]->get_current_voxel_index(); 
+		if( n >= 0 && n < number_of_mesh_voxels )
+		{ voxel_end[n+1]++; }
+		else
+		{ agents_without_voxel.push_back( basic_agent_list[i] ); }
+	}
+	for( int n=0; n < number_of_mesh_voxels ; n++ )
+	{ voxel_end[n+1] += voxel_end[n]; }
+	
+	// scatter, keeping the list order within each voxel; voxel_end[n] then marks the end of voxel n 
+	agents_by_voxel.resize( voxel_end[number_of_mesh_voxels] ); 
+	for( unsigned int i=0; i < basic_agent_list.size() ; i++ )
+	{
+		int n = basic_agent_list[i]->get_current_voxel_index(); 
+		if( n >= 0 && n < number_of_mesh_voxels )
+		{
+			agents_by_voxel[ voxel_end[n] ] = basic_agent_list[i]; 
+			voxel_end[n]++; 
+		}
+	}
+	
+	// keep the occupied voxels only 
+	agent_bin_start.clear(); 
+	int start = 0; 
+	for( int n=0; n < number_of_mesh_voxels ; n++ )
+	{
+		if( voxel_end[n] > start )
+		{ agent_bin_start.push_back( start ); }
+		start = voxel_end[n]; 
+	}
+	agent_bin_start.push_back( agents_by_voxel.size() ); 
+	return; 
+}
+
+int Microenvironment::number_of_agent_bins( void )
+{ return (int) agent_bin_start.size() - 1; }
+
 void Microenvironment::simulate_cell_sources_and_sinks( std::vector<Basic_Agent*>& basic_agent_list , double dt )
 {
-	#pragma omp parallel for
-	for( unsigned int i=0 ; i < basic_agent_list.size() ; i++ )
-	{		
-		basic_agent_list[i]->simulate_secretion_and_uptake( this , dt ); 
+	// also sum the source strength of quasi-steady substrates, per thread 
+	bool track_sources = quasi_steady_state_source_tracking_enabled(); 
+	if( track_sources )
+	{ reset_quasi_steady_state_sources(); }
+	
+	if( deterministic_cell_sources_and_sinks )
+	{
+		bin_agents_by_voxel( basic_agent_list ); 
+		#pragma omp parallel 
+		{
+			std::vector<double> sources; 
+			#pragma omp for 
+			for( int m=0; m < number_of_agent_bins() ; m++ )
+			{
+				for( int i=agent_bin_start[m]; i < agent_bin_start[m+1] ; i++ )
+				{
+					agents_by_voxel[i]->simulate_secretion_and_uptake( this , dt ); 
+					if( track_sources )
+					{ add_quasi_steady_state_sources( agents_by_voxel[i] , sources ); }
+				}
+			}
+			merge_quasi_steady_state_sources( sources ); 
+		}
+		for( unsigned int i=0; i < agents_without_voxel.size() ; i++ )
+		{ agents_without_voxel[i]->simulate_secretion_and_uptake( this , dt ); }
+		return; 
+	}
+	
+	#pragma omp parallel 
+	{
+		std::vector<double> sources; 
+		#pragma omp for
+		for( unsigned int i=0 ; i < basic_agent_list.size() ; i++ )
+		{		
+			basic_agent_list[i]->simulate_secretion_and_uptake( this , dt ); 
+			if( track_sources )
+			{ add_quasi_steady_state_sources( basic_agent_list[i] , sources ); }
+		}
+		merge_quasi_steady_state_sources( sources ); 
 	}
 	
 	return; 
@@ -781,8 +1444,29 @@ void Microenvironment::simulate_cell_sources_and_sinks( double dt )
 	simulate_cell_sources_and_sinks(all_basic_agents, dt);
 }
 
+bool Microenvironment::bulk_rates_cached( void )
+{
+	if( bulk_rates_are_cached == false )
+	{ return false; }
+	if( bulk_supply_rate_function != cached_bulk_supply_rate_function || 
+		bulk_supply_target_densities_function != cached_bulk_supply_target_densities_function || 
+		bulk_uptake_rate_function != cached_bulk_uptake_rate_function || 
+		supply_rates.size() != number_of_voxels() || supply_rates[0].size() != number_of_densities() )
+	{
+		bulk_rates_are_cached = false; 
+		fused_bulk_coefficients_up_to_date = false; 
+	}
+	return bulk_rates_are_cached; 
+}
+
 void Microenvironment::update_rates( void )
 {
+	fused_bulk_coefficients_up_to_date = false; 
+	bulk_rates_are_cached = true; 
+	cached_bulk_supply_rate_function = bulk_supply_rate_function; 
+	cached_bulk_supply_target_densities_function = bulk_supply_target_densities_function; 
+	cached_bulk_uptake_rate_function = bulk_uptake_rate_function; 
+
 	if( supply_target_densities_times_supply_rates.size() != number_of_voxels() )
 	{ supply_target_densities_times_supply_rates.assign( number_of_voxels() , zero ); }
 
@@ -807,10 +1491,7 @@ void Microenvironment::update_rates( void )
 std::vector<gradient>& Microenvironment::gradient_vector(int i, int j, int k)
 {
 	int n = voxel_index(i,j,k);
-	if( gradient_vector_computed[n] == false )
-	{
-		compute_gradient_vector( n );
-	}
+	ensure_gradient_vector( n );
 	
 	return gradient_vectors[n];
 }
@@ -818,10 +1499,7 @@ std::vector<gradient>& Microenvironment::gradient_vector(int i, int j, int k)
 std::vector<gradient>& Microenvironment::gradient_vector(int i, int j )
 {
 	int n = voxel_index(i,j,0);
-	if( gradient_vector_computed[n] == false )
-	{
-		compute_gradient_vector( n );
-	}
+	ensure_gradient_vector( n );
 	
 	return gradient_vectors[n];
 }
@@ -829,198 +1507,231 @@ std::vector<gradient>& Microenvironment::gradient_vector(int i, int j )
 std::vector<gradient>& Microenvironment::gradient_vector(int n )
 {
 	// if the gradient has not yet been computed, then do it!
-	if( gradient_vector_computed[n] == false )
+	ensure_gradient_vector( n ); 
+	return gradient_vectors[n];
+}
+
+void Microenvironment::ensure_gradient_vector( int n )
+{
+	char state; 
+	#pragma omp atomic read 
+	state = gradient_vector_computed[n]; 
+	if( state & 2 )
 	{
-		compute_gradient_vector( n );
+		#pragma omp flush 
+		return; 
 	}
 	
-	
-	return gradient_vectors[n];
+	// the first thread to claim the voxel computes it; the others wait for it 
+	#pragma omp atomic capture 
+	{ state = gradient_vector_computed[n]; gradient_vector_computed[n] |= 1; }
+	if( state == 0 )
+	{
+		compute_gradient_vector( n ); 
+		#pragma omp flush 
+		#pragma omp atomic update 
+		gradient_vector_computed[n] |= 2; 
+		return; 
+	}
+	while( ( state & 2 ) == 0 )
+	{
+		#pragma omp atomic read 
+		state = gradient_vector_computed[n]; 
+	}
+	#pragma omp flush 
+	return; 
 }
 	
 std::vector<gradient>& Microenvironment::nearest_gradient_vector( std::vector<double>& position )
 {
 	int n = nearest_voxel_index( position );
-	if( gradient_vector_computed[n] == false )
-	{
-		compute_gradient_vector( n );
-	}
+	ensure_gradient_vector( n );
 	
 	return gradient_vectors[n];
 }
 
+bool Microenvironment::gradient_substrate_selected( int substrate_index )
+{
+	if( gradient_substrate_mask.size() != number_of_densities() )
+	{ return true; }
+	return gradient_substrate_mask[substrate_index]; 
+}
+
+const double* Microenvironment::gradient_data( int substrate_index , int component )
+{
+	if( gradient_storage_up_to_date == false || gradient_storage_slot[substrate_index] < 0 )
+	{ return NULL; }
+	return gradient_storage.data() + (3*gradient_storage_slot[substrate_index]+component)*gradient_storage_stride; 
+}
+
 void Microenvironment::compute_all_gradient_vectors( void )
 {
-	static double two_dx = mesh.dx; 
-	static double two_dy = mesh.dy; 
-	static double two_dz = mesh.dz; 
-	static bool gradient_constants_defined = false; 
-	if( gradient_constants_defined == false )
+	int nx = mesh.x_coordinates.size(); 
+	int ny = mesh.y_coordinates.size(); 
+	int nz = mesh.z_coordinates.size(); 
+	double two_dx = 2.0 * mesh.dx; 
+	double two_dy = 2.0 * mesh.dy; 
+	double two_dz = 2.0 * mesh.dz; 
+	
+	std::vector<int> selected; 
+	gradient_storage_slot.assign( number_of_densities() , -1 ); 
+	for( unsigned int q=0; q < number_of_densities() ; q++ )
 	{
-		two_dx *= 2.0; 
-		two_dy *= 2.0; 
-		two_dz *= 2.0;
-		gradient_constants_defined = true; 
+		if( gradient_substrate_selected( q ) )
+		{
+			gradient_storage_slot[q] = selected.size(); 
+			selected.push_back( q ); 
+		}
 	}
 	
+	// pad each component to whole cache lines 
+	gradient_storage_stride = mesh.voxels.size() + 7 - ( mesh.voxels.size() + 7 ) % 8; 
+	if( gradient_storage.size() != 3*selected.size()*gradient_storage_stride )
+	{ gradient_storage.assign( 3*selected.size()*gradient_storage_stride , 0.0 ); }
+	
+	// selected substrates, on the whole mesh. One-sided differences at the edges. 
+	
 	#pragma omp parallel for 
-	for( unsigned int k=0; k < mesh.z_coordinates.size() ; k++ )
+	for( int line=0; line < ny*nz ; line++ )
 	{
-		for( unsigned int j=0; j < mesh.y_coordinates.size() ; j++ )
+		int j = line % ny; 
+		int k = line / ny; 
+		for( unsigned int s=0; s < selected.size() ; s++ )
 		{
-			// endcaps 
-			for( unsigned int q=0; q < number_of_densities() ; q++ )
+			int q = selected[s]; 
+			double* gx = gradient_storage.data() + (3*s+0)*gradient_storage_stride; 
+			double* gy = gradient_storage.data() + (3*s+1)*gradient_storage_stride; 
+			double* gz = gradient_storage.data() + (3*s+2)*gradient_storage_stride; 
+			for( int i=0; i < nx ; i++ )
 			{
-				int i = 0; 
-				int n = voxel_index(i,j,k);
-				// x-derivative of qth substrate at voxel n
-				gradient_vectors[n][q][0] = (*p_density_vectors)[n+thomas_i_jump][q]; 
-				gradient_vectors[n][q][0] -= (*p_density_vectors)[n][q]; 
-				gradient_vectors[n][q][0] /= mesh.dx; 
+				int n = voxel_index(i,j,k); 
+				const double rho = (*p_density_vectors)[n][q]; 
 				
-				gradient_vector_computed[n] = true; 
-			}
-			for( unsigned int q=0; q < number_of_densities() ; q++ )
-			{
-				int i = mesh.x_coordinates.size()-1; 
-				int n = voxel_index(i,j,k);
-				// x-derivative of qth substrate at voxel n
-				gradient_vectors[n][q][0] = (*p_density_vectors)[n][q]; 
-				gradient_vectors[n][q][0] -= (*p_density_vectors)[n-thomas_i_jump][q]; 
-				gradient_vectors[n][q][0] /= mesh.dx; 
+				if( nx == 1 )
+				{ gx[n] = 0.0; }
+				else if( i == 0 )
+				{ gx[n] = ( (*p_density_vectors)[n+thomas_i_jump][q] - rho ) / mesh.dx; }
+				else if( i == nx-1 )
+				{ gx[n] = ( rho - (*p_density_vectors)[n-thomas_i_jump][q] ) / mesh.dx; }
+				else
+				{ gx[n] = ( (*p_density_vectors)[n+thomas_i_jump][q] - (*p_density_vectors)[n-thomas_i_jump][q] ) / two_dx; }
 				
-				gradient_vector_computed[n] = true; 
-			}
-			
-			for( unsigned int i=1; i < mesh.x_coordinates.size()-1 ; i++ )
-			{
-				for( unsigned int q=0; q < number_of_densities() ; q++ )
-				{
-					int n = voxel_index(i,j,k);
-					// x-derivative of qth substrate at voxel n
-					gradient_vectors[n][q][0] = (*p_density_vectors)[n+thomas_i_jump][q]; 
-					gradient_vectors[n][q][0] -= (*p_density_vectors)[n-thomas_i_jump][q]; 
-					gradient_vectors[n][q][0] /= two_dx; 
-					
-					gradient_vector_computed[n] = true; 
- 				}
+				if( ny == 1 )
+				{ gy[n] = 0.0; }
+				else if( j == 0 )
+				{ gy[n] = ( (*p_density_vectors)[n+thomas_j_jump][q] - rho ) / mesh.dy; }
+				else if( j == ny-1 )
+				{ gy[n] = ( rho - (*p_density_vectors)[n-thomas_j_jump][q] ) / mesh.dy; }
+				else
+				{ gy[n] = ( (*p_density_vectors)[n+thomas_j_jump][q] - (*p_density_vectors)[n-thomas_j_jump][q] ) / two_dy; }
+				
+				if( nz == 1 )
+				{ gz[n] = 0.0; }
+				else if( k == 0 )
+				{ gz[n] = ( (*p_density_vectors)[n+thomas_k_jump][q] - rho ) / mesh.dz; }
+				else if( k == nz-1 )
+				{ gz[n] = ( rho - (*p_density_vectors)[n-thomas_k_jump][q] ) / mesh.dz; }
+				else
+				{ gz[n] = ( (*p_density_vectors)[n+thomas_k_jump][q] - (*p_density_vectors)[n-thomas_k_jump][q] ) / two_dz; }
 			}
-			
 		}
 	}
+	gradient_storage_up_to_date = true; 
 	
-	#pragma omp parallel for 
-	for( unsigned int k=0; k < mesh.z_coordinates.size() ; k++ )
+	// fill the per-voxel gradient vectors where agents can read them; the rest are 
+	// assembled on demand (once, see ensure_gradient_vector) by gradient_vector() 
+	
+	gradient_vector_computed.assign( mesh.voxels.size() , 0 ); 
+	std::vector<int> occupied_voxels; 
+	for( unsigned int a=0; a < all_basic_agents.size() ; a++ )
 	{
-		for( unsigned int i=0; i < mesh.x_coordinates.size() ; i++ )
+		int n = all_basic_agents[a]->get_current_voxel_index(); 
+		if( all_basic_agents[a]->get_microenvironment() != this || n < 0 || n >= (int) mesh.voxels.size() )
+		{ continue; }
+		if( gradient_vector_computed[n] == 0 )
 		{
-			// endcaps 
-			for( unsigned int q=0; q < number_of_densities() ; q++ )
-			{
-				int j = 0; 
-				int n = voxel_index(i,j,k);
-				// x-derivative of qth substrate at voxel n
-				gradient_vectors[n][q][1] = (*p_density_vectors)[n+thomas_j_jump][q]; 
-				gradient_vectors[n][q][1] -= (*p_density_vectors)[n][q]; 
-				gradient_vectors[n][q][1] /= mesh.dy; 
-				
-				gradient_vector_computed[n] = true; 
-			}
-			for( unsigned int q=0; q < number_of_densities() ; q++ )
-			{
-				int j = mesh.y_coordinates.size()-1; 
-				int n = voxel_index(i,j,k);
-				// x-derivative of qth substrate at voxel n
-				gradient_vectors[n][q][1] = (*p_density_vectors)[n][q]; 
-				gradient_vectors[n][q][1] -= (*p_density_vectors)[n-thomas_j_jump][q]; 
-				gradient_vectors[n][q][1] /= mesh.dy; 
-				
-				gradient_vector_computed[n] = true; 
-			}		
-			
-			for( unsigned int j=1; j < mesh.y_coordinates.size()-1 ; j++ )
-			{
-				for( unsigned int q=0; q < number_of_densities() ; q++ )
-				{
-					int n = voxel_index(i,j,k);
-					// y-derivative of qth substrate at voxel n
-					gradient_vectors[n][q][1] = (*p_density_vectors)[n+thomas_j_jump][q]; 
-					gradient_vectors[n][q][1] -= (*p_density_vectors)[n-thomas_j_jump][q]; 
-					gradient_vectors[n][q][1] /= two_dy; 
-					gradient_vector_computed[n] = true; 
-				}
-			}
-			
+			gradient_vector_computed[n] = 2; 
+			occupied_voxels.push_back( n ); 
 		}
 	}
 	
-	// don't bother computing z component if there is no z-directoin 
-	if( mesh.z_coordinates.size() == 1 )
-	{ return; }
-
 	#pragma omp parallel for 
-	for( unsigned int j=0; j < mesh.y_coordinates.size() ; j++ )
+	for( int m=0; m < (int) occupied_voxels.size() ; m++ )
+	{ assemble_gradient_vector( occupied_voxels[m] ); }
+
+	return; 
+}
+
+void Microenvironment::gradient_from_stencil( int n , int q , double* output )
+{
+	// same differences as compute_all_gradient_vectors, for a single voxel 
+	int nx = mesh.x_coordinates.size(); 
+	int ny = mesh.y_coordinates.size(); 
+	int nz = mesh.z_coordinates.size(); 
+	int i = n % nx; 
+	int j = ( n / nx ) % ny; 
+	int k = n / ( nx*ny ); 
+	const double rho = (*p_density_vectors)[n][q]; 
+	
+	if( nx == 1 )
+	{ output[0] = 0.0; }
+	else if( i == 0 )
+	{ output[0] = ( (*p_density_vectors)[n+thomas_i_jump][q] - rho ) / mesh.dx; }
+	else if( i == nx-1 )
+	{ output[0] = ( rho - (*p_density_vectors)[n-thomas_i_jump][q] ) / mesh.dx; }
+	else
+	{ output[0] = ( (*p_density_vectors)[n+thomas_i_jump][q] - (*p_density_vectors)[n-thomas_i_jump][q] ) / ( 2.0 * mesh.dx ); }
+	
+	if( ny == 1 )
+	{ output[1] = 0.0; }
+	else if( j == 0 )
+	{ output[1] = ( (*p_density_vectors)[n+thomas_j_jump][q] - rho ) / mesh.dy; }
+	else if( j == ny-1 )
+	{ output[1] = ( rho - (*p_density_vectors)[n-thomas_j_jump][q] ) / mesh.dy; }
+	else
+	{ output[1] = ( (*p_density_vectors)[n+thomas_j_jump][q] - (*p_density_vectors)[n-thomas_j_jump][q] ) / ( 2.0 * mesh.dy ); }
+	
+	if( nz == 1 )
+	{ output[2] = 0.0; }
+	else if( k == 0 )
+	{ output[2] = ( (*p_density_vectors)[n+thomas_k_jump][q] - rho ) / mesh.dz; }
+	else if( k == nz-1 )
+	{ output[2] = ( rho - (*p_density_vectors)[n-thomas_k_jump][q] ) / mesh.dz; }
+	else
+	{ output[2] = ( (*p_density_vectors)[n+thomas_k_jump][q] - (*p_density_vectors)[n-thomas_k_jump][q] ) / ( 2.0 * mesh.dz ); }
+	return; 
+}
+
+void Microenvironment::assemble_gradient_vector( int n )
+{
+	for( unsigned int q=0; q < number_of_densities() ; q++ )
 	{
-		for( unsigned int i=0; i < mesh.x_coordinates.size() ; i++ )
+		int slot = gradient_storage_slot[q]; 
+		if( slot >= 0 )
 		{
-			// endcaps 
-			for( unsigned int q=0; q < number_of_densities() ; q++ )
-			{
-				int k = 0; 
-				int n = voxel_index(i,j,k);
-				// x-derivative of qth substrate at voxel n
-				gradient_vectors[n][q][2] = (*p_density_vectors)[n+thomas_k_jump][q]; 
-				gradient_vectors[n][q][2] -= (*p_density_vectors)[n][q]; 
-				gradient_vectors[n][q][2] /= mesh.dz; 
-				
-				gradient_vector_computed[n] = true; 
-			}
-			for( unsigned int q=0; q < number_of_densities() ; q++ )
-			{
-				int k = mesh.z_coordinates.size()-1; 
-				int n = voxel_index(i,j,k);
-				// x-derivative of qth substrate at voxel n
-				gradient_vectors[n][q][2] = (*p_density_vectors)[n][q]; 
-				gradient_vectors[n][q][2] -= (*p_density_vectors)[n-thomas_k_jump][q]; 
-				gradient_vectors[n][q][2] /= mesh.dz; 
-				
-				gradient_vector_computed[n] = true; 
-			}			
-			
-			for( unsigned int k=1; k < mesh.z_coordinates.size()-1 ; k++ )
-			{
-				for( unsigned int q=0; q < number_of_densities() ; q++ )
-				{
-					int n = voxel_index(i,j,k);
-					// y-derivative of qth substrate at voxel n
-					gradient_vectors[n][q][2] = (*p_density_vectors)[n+thomas_k_jump][q]; 
-					gradient_vectors[n][q][2] -= (*p_density_vectors)[n-thomas_k_jump][q]; 
-					gradient_vectors[n][q][2] /= two_dz; 
-					gradient_vector_computed[n] = true; 
-				}
-			}
-			
+			for( int d=0; d < 3 ; d++ )
+			{ gradient_vectors[n][q][d] = gradient_storage[ (3*slot+d)*gradient_storage_stride + n ]; }
 		}
+		else
+		{ gradient_from_stencil( n , q , gradient_vectors[n][q].data() ); }
 	}
-
 	return; 
 }
 
 void Microenvironment::compute_gradient_vector( int n )
 {
-	static double two_dx = mesh.dx; 
-	static double two_dy = mesh.dy; 
-	static double two_dz = mesh.dz; 
-	static bool gradient_constants_defined = false; 
-	std::vector<unsigned int> indices(3,0);
-	
-	if( gradient_constants_defined == false )
+	// after compute_all_gradient_vectors, use the same (stored) gradients 
+	if( gradient_storage_up_to_date && gradient_storage_slot.size() == number_of_densities() )
 	{
-		two_dx *= 2.0; 
-		two_dy *= 2.0; 
-		two_dz *= 2.0;
-		gradient_constants_defined = true; 
-	}	
+		assemble_gradient_vector( n ); 
+		return; 
+	}
+	
+	// locals, not statics: several threads can get here at once 
+	double two_dx = 2.0 * mesh.dx; 
+	double two_dy = 2.0 * mesh.dy; 
+	double two_dz = 2.0 * mesh.dz; 
+	std::vector<unsigned int> indices(3,0);
 	
 	indices = cartesian_indices( n );
 	
@@ -1032,7 +1743,6 @@ void Microenvironment::compute_gradient_vector( int n )
 			gradient_vectors[n][q][0] = (*p_density_vectors)[n+thomas_i_jump][q]; 
 			gradient_vectors[n][q][0] -= (*p_density_vectors)[n-thomas_i_jump][q]; 
 			gradient_vectors[n][q][0] /= two_dx; 
-			gradient_vector_computed[n] = true; 
 		}
 	}
 	
@@ -1048,7 +1758,6 @@ void Microenvironment::compute_gradient_vector( int n )
 			gradient_vectors[n][q][1] = (*p_density_vectors)[n+thomas_j_jump][q]; 
 			gradient_vectors[n][q][1] -= (*p_density_vectors)[n-thomas_j_jump][q]; 
 			gradient_vectors[n][q][1] /= two_dy; 
-			gradient_vector_computed[n] = true; 
 		}
 	}
 	
@@ -1064,7 +1773,6 @@ void Microenvironment::compute_gradient_vector( int n )
 			gradient_vectors[n][q][2] = (*p_density_vectors)[n+thomas_k_jump][q]; 
 			gradient_vectors[n][q][2] -= (*p_density_vectors)[n-thomas_k_jump][q]; 
 			gradient_vectors[n][q][2] /= two_dz; 
-			gradient_vector_computed[n] = true; 
 		}
 	}
 	
@@ -1080,7 +1788,8 @@ void Microenvironment::reset_all_gradient_vectors( void )
 			(gradient_vectors[k])[i].resize( 3, 0.0 );
 		}
 	}
-	gradient_vector_computed.assign( mesh.voxels.size() , false ); 	
+	gradient_vector_computed.assign( mesh.voxels.size() , 0 ); 	
+	gradient_storage_up_to_date = false; 
 }
 
 
@@ -1130,6 +1839,13 @@ Microenvironment_Options::Microenvironment_Options()
 	calculate_gradients = false; 
 	
 	track_internalized_substrates_in_each_agent = false; 
+	
+	use_contiguous_density_storage = false; 
+	contiguous_density_layout = substrate_major_density_layout; 
+	vectorized_thomas_solver = false; 
+	thomas_sweep_block_size = 64; 
+	fused_bulk_source_sink = false; 
+	deterministic_cell_sources_and_sinks = false; 
 
 	Dirichlet_all.push_back( true ); 
 //	Dirichlet_interior.push_back( true ); 
@@ -1156,6 +1872,17 @@ void initialize_microenvironment( void )
 {
 	// create and name a microenvironment; 
 	microenvironment.name = default_microenvironment_options.name;
+	// contiguous density storage for the solvers? 
+	if( default_microenvironment_options.use_contiguous_density_storage == true )
+	{ microenvironment.enable_contiguous_density_storage( default_microenvironment_options.contiguous_density_layout ); }
+	if( default_microenvironment_options.vectorized_thomas_solver == true )
+	{ microenvironment.enable_vectorized_thomas_sweeps( true ); }
+	microenvironment.set_thomas_sweep_block_size( default_microenvironment_options.thomas_sweep_block_size ); 
+	if( default_microenvironment_options.fused_bulk_source_sink == true )
+	{ microenvironment.enable_fused_bulk_source_sink( true ); }
+	if( default_microenvironment_options.deterministic_cell_sources_and_sinks == true )
+	{ microenvironment.enable_deterministic_cell_sources_and_sinks( true ); }
+	
 	// register the diffusion solver 
 	if( default_microenvironment_options.simulate_2D == true )
 	{
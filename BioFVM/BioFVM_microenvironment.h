@@ -53,12 +53,17 @@
 #include "BioFVM_mesh.h"
 #include "BioFVM_agent_container.h"
 #include "BioFVM_MultiCellDS.h"
+#include "BioFVM_vector.h"
 
 namespace BioFVM{
 
 /* and now some gradients */ 
 typedef std::vector<double> gradient; 
 
+/* layouts for contiguous density storage */ 
+static const int voxel_major_density_layout = 0; // [voxel][substrate]
+static const int substrate_major_density_layout = 1; // [substrate][voxel]
+
 /*! /brief   */
 
 class Basic_Agent; 
@@ -83,8 +88,31 @@ class Microenvironment
 	/*! stores pointer to current density solutions. Access via operator() functions. */ 
 	std::vector< std::vector<double> >* p_density_vectors; 
 	
+	/*! contiguous density storage: all densities in one aligned, flat buffer. The 
+	    per-voxel vectors above remain the views used by agents and custom code; 
+	    the LOD sweeps load from them in the first sweep, work on this buffer, and 
+	    store back in the last sweep. */ 
+	bool contiguous_density_storage; 
+	int contiguous_density_layout; 
+	unsigned int contiguous_density_stride; // densities per voxel (voxel-major) or padded voxels per substrate (substrate-major)
+	aligned_double_vector contiguous_densities; 
+	/*! solve batches of neighboring lines in SIMD lanes (needs substrate-major storage) */ 
+	bool vectorized_thomas_sweeps; 
+	int thomas_block_size; // adjacent i-columns per tile in the vectorized y/z sweeps (0: whole rows)
+	
 	std::vector< std::vector<gradient> > gradient_vectors; 
-	std::vector<bool> gradient_vector_computed; 
+	std::vector<char> gradient_vector_computed; // 0: not yet, 1: being computed, 2: done 
+	/*! flat (structure-of-arrays) gradients of the selected substrates, written by 
+	    compute_all_gradient_vectors: component d of the s-th selected substrate at voxel n 
+	    is at gradient_storage[ (3*s+d)*gradient_storage_stride + n ] */ 
+	aligned_double_vector gradient_storage; 
+	unsigned int gradient_storage_stride; 
+	std::vector<int> gradient_storage_slot; // s for each stored substrate, -1 for the others 
+	bool gradient_storage_up_to_date; 
+	void gradient_from_stencil( int n , int substrate_index , double* output ); 
+	void assemble_gradient_vector( int n ); 
+	// computes gradient_vectors[n] once, even if several threads ask for it 
+	void ensure_gradient_vector( int n ); 
 
 	
 	/*! helpful for solvers -- resize these whenever adding/removing substrates */ 
@@ -121,11 +149,6 @@ class Microenvironment
 	
 	// on "resize density" type operations, need to extend all of these 
 	
-	/*
-	std::vector<int> dirichlet_indices; 
-	std::vector< std::vector<double> > dirichlet_value_vectors; 
-	std::vector<bool> dirichlet_node_map; 
-	*/
 	std::vector< std::vector<double> > dirichlet_value_vectors; 
 	std::vector<bool> dirichlet_activation_vector; 
 	
@@ -134,6 +157,53 @@ class Microenvironment
 	   
 	std::vector< std::vector<bool> > dirichlet_activation_vectors; 
 	
+	/*! compact list of the Dirichlet voxels, with their values and activations packed 
+	    as [m*dirichlet_packed_stride + substrate], so applying the conditions does not 
+	    scan the mesh. Kept current by add/update/remove_dirichlet_node and the 
+	    activation setters; other changes mark it out of date to rebuild on next use. */ 
+	std::vector<int> dirichlet_indices; 
+	std::vector<int> dirichlet_list_position; // position in dirichlet_indices for each voxel, or -1 
+	std::vector<double> dirichlet_packed_values; 
+	std::vector<bool> dirichlet_packed_activation; 
+	unsigned int dirichlet_packed_stride; 
+	bool dirichlet_list_up_to_date; 
+	void rebuild_dirichlet_list( void ); 
+	void add_to_dirichlet_list( int voxel_index ); 
+	void pack_dirichlet_node( int voxel_index ); 
+	void remove_from_dirichlet_list( int voxel_index ); 
+	
+	/*! quasi-steady-state bookkeeping: diffusion steps since the last solve, and the 
+	    cell source/sink strength at that solve (see quasi_steady_state_source_total) */ 
+	std::vector<int> quasi_steady_state_step_counts; 
+	std::vector<double> quasi_steady_state_source_totals; 
+	/*! the current strength, summed by the cell source/sink loops (empty until one has run) */ 
+	std::vector<double> quasi_steady_state_current_source_totals; 
+	
+	/*! number of calls to simulate_diffusion_decay (for multi-rate time stepping) */ 
+	int diffusion_step_count; 
+	
+	/*! fused bulk sources/sinks: simulate_bulk_sources_and_sinks only schedules the update, 
+	    rho = (rho + source)/denominator, and the next 2-D/3-D LOD solve applies it in its first 
+	    sweep. The coefficients are stored like the contiguous densities, built from the rates 
+	    cached by update_rates(), and are the identity on active Dirichlet nodes. */ 
+	bool fused_bulk_source_sink; 
+	bool bulk_source_sink_pending; 
+	double bulk_source_sink_dt; 
+	bool fused_bulk_coefficients_up_to_date; 
+	aligned_double_vector fused_bulk_source; 
+	aligned_double_vector fused_bulk_denominator; 
+	void update_fused_bulk_coefficients( void ); 
+	bool bulk_source_sink_can_be_fused( void ); 
+	
+	/*! set by update_rates(), with the bulk functions it evaluated (see bulk_rates_cached) */ 
+	bool bulk_rates_are_cached; 
+	void (*cached_bulk_supply_rate_function)( Microenvironment* , int , std::vector<double>* ); 
+	void (*cached_bulk_supply_target_densities_function)( Microenvironment* , int , std::vector<double>* ); 
+	void (*cached_bulk_uptake_rate_function)( Microenvironment* , int , std::vector<double>* ); 
+	
+	/*! update each voxel from one thread, its agents in list order (see bin_agents_by_voxel) */ 
+	bool deterministic_cell_sources_and_sinks; 
+	
  public:
 	
 	/*! The mesh for the diffusing quantities */ 
@@ -151,10 +221,46 @@ class Microenvironment
 	std::vector< double > diffusion_coefficients; 
 	std::vector< double > decay_rates; 
 	
+	/*! multi-rate time stepping: substrate q advances only every diffusion_time_step_multiples[q] 
+	    diffusion steps, by that many times the diffusion dt (default 1: every step). Applies to the 
+	    2-D/3-D LOD solvers and cell and bulk sources/sinks. Use set_diffusion_time_step_multiple() 
+	    after the solver has been set up, so its coefficients are recomputed. */ 
+	std::vector< int > diffusion_time_step_multiples; 
+	void set_diffusion_time_step_multiple( int substrate_index , int multiple ); 
+	bool multirate_time_stepping_enabled( void ); 
+	bool substrate_is_due( int substrate_index ); // in the current diffusion step 
+	/*! the time accumulated by substrate q between two due steps, m*dt */ 
+	double substrate_time_step( int substrate_index , double dt ); 
+	std::vector<double> substrate_time_steps( double dt ); 
+	
+	/*! quasi-steady-state substrates: every quasi_steady_state_intervals[q] diffusion steps 
+	    (0: never, the default), substrate q is replaced by the steady state of diffusion, decay, 
+	    and bulk and cell sources/sinks. It is solved sooner if the total cell source/sink 
+	    strength changes by more than the fraction quasi_steady_state_source_thresholds[q] (0: off). */ 
+	std::vector< int > quasi_steady_state_intervals; 
+	std::vector< double > quasi_steady_state_source_thresholds; 
+	double quasi_steady_state_tolerance; // relative residual 
+	int quasi_steady_state_max_iterations; 
+	void simulate_quasi_steady_state_substrates( void ); 
+	bool quasi_steady_state_enabled( void ); 
+	bool substrate_is_quasi_steady( int substrate_index ); 
+	/*! the transient solvers and the bulk and cell sources/sinks advance substrate q in the 
+	    current diffusion step: it is due, and not quasi-steady (its solve includes them) */ 
+	bool substrate_is_advanced( int substrate_index ); 
+	/*! the cell source/sink loops also sum the strength that triggers early quasi-steady-state 
+	    solves: reset, add each agent to a per-thread total, then merge the per-thread totals */ 
+	bool quasi_steady_state_source_tracking_enabled( void ); 
+	void reset_quasi_steady_state_sources( void ); 
+	void add_quasi_steady_state_sources( Basic_Agent* pA , std::vector<double>& totals ); 
+	void merge_quasi_steady_state_sources( const std::vector<double>& totals ); 
+	
 	std::vector< std::vector<double> > supply_target_densities_times_supply_rates; 
 	std::vector< std::vector<double> > supply_rates; 
 	std::vector< std::vector<double> > uptake_rates; 
 	void update_rates( void ); 
+	/*! the rates cached by the last update_rates() still belong to the bulk functions: none of 
+	    them has been reassigned since, and the mesh and densities have the same size */ 
+	bool bulk_rates_cached( void ); 
 	
 	Microenvironment(); 
 	Microenvironment(std::string name);
@@ -218,6 +324,18 @@ class Microenvironment
 	void compute_gradient_vector( int n );  
 	void reset_all_gradient_vectors( void ); 
 	
+	/*! substrates whose gradients compute_all_gradient_vectors evaluates on the whole mesh 
+	    (empty: all of them). The others are evaluated only in voxels that hold an agent, 
+	    and elsewhere on demand. */ 
+	std::vector<bool> gradient_substrate_mask; 
+	/*! false until the mask is set, and again whenever cell definitions, rules, or 
+	    substrates change */ 
+	bool gradient_substrate_mask_up_to_date; 
+	bool gradient_substrate_selected( int substrate_index ); 
+	/*! component (0,1,2) of the stored gradient of a selected substrate, indexed by voxel. 
+	    NULL if it is not stored. Valid until the next compute_all_gradient_vectors. */ 
+	const double* gradient_data( int substrate_index , int component ); 
+	
 	/*! access the density vector at  [ X(i),Y(j),Z(k) ] */
 	std::vector<double>& density_vector( int i, int j, int k ); 
 	/*! access the density vector at  [ X(i),Y(j),0 ]  -- helpful for 2-D problems */
@@ -225,17 +343,63 @@ class Microenvironment
 	/*! access the density vector at [x,y,z](n) */
 	std::vector<double>& density_vector( int n ); 
 
+	/*! contiguous density storage (see above). layout is voxel_major_density_layout 
+	    or substrate_major_density_layout */ 
+	void enable_contiguous_density_storage( int layout ); 
+	void disable_contiguous_density_storage( void ); 
+	bool contiguous_density_storage_enabled( void ); 
+	int density_storage_layout( void ); 
+	unsigned int density_storage_stride( void ); 
+	double* contiguous_density_data( void ); 
+	/*! flat index of substrate q in voxel n */ 
+	unsigned int contiguous_density_index( int n , int q ); 
+	/*! (re)size the contiguous buffer if the mesh or the substrates have changed */ 
+	void resize_contiguous_storage( void ); 
+	/*! copy the per-voxel density vectors into the contiguous buffer (and back) */ 
+	void copy_densities_to_contiguous_storage( void ); 
+	void copy_densities_from_contiguous_storage( void ); 
+	void apply_dirichlet_conditions_to_contiguous_storage( void ); 
+	/*! vectorized (batched) Thomas sweeps in the LOD solvers. Enabling this switches 
+	    to substrate-major contiguous storage; disable it to compare with the scalar path. */ 
+	void enable_vectorized_thomas_sweeps( bool new_value ); 
+	bool vectorized_thomas_sweeps_enabled( void ); 
+	/*! number of adjacent i-columns swept together in the vectorized y- and z-sweeps (0: whole rows) */ 
+	void set_thomas_sweep_block_size( int new_value ); 
+	int thomas_sweep_block_size( void ); 
+
 	/*! advance the diffusion-decay solver by dt time */
 	void simulate_diffusion_decay( double dt ); 
 	
 	/*! advance the source/sink solver by dt time */
 	void simulate_bulk_sources_and_sinks( double dt ); 
+	/*! fold simulate_bulk_sources_and_sinks into the next LOD solve (saves a pass over the 
+	    densities). Uses the rates cached by update_rates(): call it again when the rates change. 
+	    Applies with the 2-D/3-D LOD solvers, and either the stock bulk rate functions 
+	    (zero_function, one_function) or custom ones whose rates were cached by calling 
+	    update_rates(), which opts them in as constant until the next call. Otherwise the 
+	    unfused update runs. */ 
+	void enable_fused_bulk_source_sink( bool new_value ); 
+	bool fused_bulk_source_sink_enabled( void ); 
 	
 	// use the supplied list of cells
 	void simulate_cell_sources_and_sinks( std::vector<Basic_Agent*>& basic_agent_list , double dt ); 
 	// use the global list of cells 
 	void simulate_cell_sources_and_sinks( double dt ); 
 	
+	/*! race-free secretion/uptake: instead of one thread per agent, one thread per voxel 
+	    applies its agents in list order, so the result does not depend on the thread count */ 
+	void enable_deterministic_cell_sources_and_sinks( bool new_value ); 
+	bool deterministic_cell_sources_and_sinks_enabled( void ); 
+	
+	/*! group agents by voxel with a (stable) counting sort. The agents in the m-th occupied 
+	    voxel are agents_by_voxel[ agent_bin_start[m] ] ... agents_by_voxel[ agent_bin_start[m+1]-1 ]; 
+	    agents without a valid voxel go to agents_without_voxel. */ 
+	void bin_agents_by_voxel( std::vector<Basic_Agent*>& basic_agent_list ); 
+	int number_of_agent_bins( void ); 
+	std::vector<Basic_Agent*> agents_by_voxel; 
+	std::vector<int> agent_bin_start; 
+	std::vector<Basic_Agent*> agents_without_voxel; 
+	
 	void display_information( std::ostream& os ); 
 	
 	void add_dirichlet_node( int voxel_index, std::vector<double>& value ); 
@@ -269,6 +433,9 @@ class Microenvironment
 	friend void diffusion_decay_solver__constant_coefficients_LOD_1D( Microenvironment& S, double dt ); 
 	
 	friend void diffusion_decay_explicit_uniform_rates( Microenvironment& M, double dt );
+	friend void thomas_sweeps_on_contiguous_storage( Microenvironment& M , int dimensions );
+	friend void compute_all_gradient_vectors_mpi( Microenvironment& M ); // see BioFVM_mpi.h 
+	friend int quasi_steady_state_solver( Microenvironment& M , int substrate_index ); 
 	
 	void write_to_matlab( std::string filename );
 	void write_mesh_to_matlab( std::string filename ); // not yet written 
@@ -364,6 +531,13 @@ class Microenvironment_Options
 	bool use_oxygen_as_first_field;
 	
 	bool track_internalized_substrates_in_each_agent; 	
+	
+	bool use_contiguous_density_storage; 
+	int contiguous_density_layout; 
+	bool vectorized_thomas_solver; 
+	int thomas_sweep_block_size; 
+	bool fused_bulk_source_sink; 
+	bool deterministic_cell_sources_and_sinks; 
 };
 
 extern Microenvironment_Options default_microenvironment_options; 
@@ -0,0 +1,506 @@
+/*
+#############################################################################
+# If you use BioFVM in your project, please cite BioFVM and the version     #
+# number, such as below:                                                    #
+#                                                                           #
+# We solved the diffusion equations using BioFVM (Version 1.1.7) [1]        #
+#                                                                           #
+# [1] A. Ghaffarizadeh, S.H. Friedman, and P. Macklin, BioFVM: an efficient #
+#    parallelized diffusive transport solver for 3-D biological simulations,#
+#    Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730 #
+#                                                                           #
+#############################################################################
+#                                                                           #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)   #
+#                                                                           #
+# Copyright (c) 2015-2025, Paul Macklin and the BioFVM Project              #
+# All rights reserved.                                                      #
+#                                                                           #
+# Redistribution and use in source and binary forms, with or without        #
+# modification, are permitted provided that the following conditions are    #
+# met:                                                                      #
+#                                                                           #
+# 1. Redistributions of source code must retain the above copyright notice, #
+# this list of conditions and the following disclaimer.                     #
+#                                                                           #
+# 2. Redistributions in binary form must reproduce the above copyright      #
+# notice, this list of conditions and the following disclaimer in the       #
+# documentation and/or other materials provided with the distribution.      #
+#                                                                           #
+# 3. Neither the name of the copyright holder nor the names of its          #
+# contributors may be used to endorse or promote products derived from this #
+# software without specific prior written permission.                       #
+#                                                                           #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       #
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED #
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A           #
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER #
+# OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,  #
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       #
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        #
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    #
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      #
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              #
+#                                                                           #
+#############################################################################
+*/
+
+#ifdef BIOFVM_MPI
+
+#include "BioFVM_mpi.h"
+#include "BioFVM_vector.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace BioFVM{
+
+MPI_Slab_Decomposition mpi_slab_decomposition; 
+
+MPI_Slab_Decomposition::MPI_Slab_Decomposition()
+{
+	communicator = MPI_COMM_NULL; 
+	rank = 0; 
+	number_of_ranks = 1; 
+	
+	global_x_voxels = 1; 
+	global_y_voxels = 1; 
+	global_z_voxels = 1; 
+	global_z_start = 0.0; 
+	global_z_end = 1.0; 
+	
+	thomas_dt = -1.0; 
+	return; 
+}
+
+int MPI_Slab_Decomposition::z_slab_start_here( void )
+{ return z_slab_start[rank]; }
+
+int MPI_Slab_Decomposition::z_slab_size_here( void )
+{ return z_slab_size[rank]; }
+
+// split n items into number_of_parts contiguous parts, the first (n % parts) one larger 
+static void split_evenly( int n , int number_of_parts , std::vector<int>& start , std::vector<int>& size )
+{
+	start.assign( number_of_parts , 0 ); 
+	size.assign( number_of_parts , n / number_of_parts ); 
+	for( int r=0; r < n % number_of_parts ; r++ )
+	{ size[r]++; }
+	for( int r=1; r < number_of_parts ; r++ )
+	{ start[r] = start[r-1] + size[r-1]; }
+	return; 
+}
+
+void setup_mpi_slab_decomposition( Microenvironment& M , MPI_Comm communicator , 
+	double x_start, double x_end, double y_start, double y_end, double z_start, double z_end , 
+	double dx, double dy, double dz )
+{
+	MPI_Slab_Decomposition& D = mpi_slab_decomposition; 
+	D.communicator = communicator; 
+	MPI_Comm_rank( communicator , &D.rank ); 
+	MPI_Comm_size( communicator , &D.number_of_ranks ); 
+	
+	// same voxel counts as Cartesian_Mesh::resize 
+	double eps = 1e-16; 
+	D.global_x_voxels = (int) ceil( eps + (x_end-x_start)/dx ); 
+	D.global_y_voxels = (int) ceil( eps + (y_end-y_start)/dy ); 
+	D.global_z_voxels = (int) ceil( eps + (z_end-z_start)/dz ); 
+	D.global_z_start = z_start; 
+	D.global_z_end = z_end; 
+	
+	if( D.global_z_voxels < D.number_of_ranks )
+	{
+		std::cout << "Error: " << D.global_z_voxels << " z-voxels cannot be split across " 
+			<< D.number_of_ranks << " MPI ranks." << std::endl; 
+		exit(-1); 
+	}
+	split_evenly( D.global_z_voxels , D.number_of_ranks , D.z_slab_start , D.z_slab_size ); 
+	split_evenly( D.global_y_voxels , D.number_of_ranks , D.y_slab_start , D.y_slab_size ); 
+	
+	double local_z_start = z_start + D.z_slab_start_here() * dz; 
+	double local_z_end = local_z_start + D.z_slab_size_here() * dz; 
+	M.resize_space( x_start, x_end, y_start, y_end, local_z_start, local_z_end , dx, dy, dz ); 
+	if( (int) M.mesh.z_coordinates.size() != D.z_slab_size_here() )
+	{
+		std::cout << "Error: rank " << D.rank << " expected " << D.z_slab_size_here() << " z-voxels in its slab but the mesh has " 
+			<< M.mesh.z_coordinates.size() << ". Use a domain that is a whole number of voxels." << std::endl; 
+		exit(-1); 
+	}
+	
+	M.diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_LOD_3D_MPI; 
+	D.thomas_dt = -1.0; 
+	return; 
+}
+
+bool mpi_voxel_on_outer_boundary( Microenvironment& M , int voxel_index )
+{
+	MPI_Slab_Decomposition& D = mpi_slab_decomposition; 
+	int nx = M.mesh.x_coordinates.size(); 
+	int ny = M.mesh.y_coordinates.size(); 
+	int i = voxel_index % nx; 
+	int j = ( voxel_index / nx ) % ny; 
+	int k = voxel_index / ( nx*ny ) + D.z_slab_start_here(); 
+	return i == 0 || i == nx-1 || j == 0 || j == ny-1 || k == 0 || k == D.global_z_voxels-1; 
+}
+
+// Thomas coefficients for n voxels in one direction, as in the serial LOD solvers 
+static void setup_thomas_coefficients( int n , std::vector<double>& constant1 , std::vector<double>& constant2 , 
+	std::vector< std::vector<double> >& denom , std::vector< std::vector<double> >& c )
+{
+	int number_of_substrates = constant1.size(); 
+	std::vector<double> one( number_of_substrates , 1.0 ); 
+	
+	std::vector<double> constant1a = constant1; 
+	constant1a *= -1.0; 
+	std::vector<double> constant3 = one; // 1 + 2*constant1 + constant2 
+	constant3 += constant1; 
+	constant3 += constant1; 
+	constant3 += constant2; 
+	std::vector<double> constant3a = one; // 1 + constant1 + constant2 
+	constant3a += constant1; 
+	constant3a += constant2; 
+	
+	c.assign( n , constant1a ); 
+	denom.assign( n , constant3 ); 
+	denom[0] = constant3a; 
+	denom[n-1] = constant3a; 
+	if( n == 1 )
+	{ denom[0] = one; denom[0] += constant2; } 
+	
+	c[0] /= denom[0]; 
+	for( int i=1 ; i <= n-1 ; i++ )
+	{ 
+		axpy( &denom[i] , constant1 , c[i-1] ); 
+		c[i] /= denom[i]; 
+	}
+	return; 
+}
+
+// solve lines of voxel-major data: line l starts at first[l], its m-th voxel is m*voxel_jump further 
+static void thomas_solve_line( double* p , int length , int voxel_jump , int number_of_substrates , 
+	const std::vector<double>& constant1 , const std::vector< std::vector<double> >& denom , 
+	const std::vector< std::vector<double> >& c )
+{
+	for( int q=0; q < number_of_substrates ; q++ )
+	{ p[q] /= denom[0][q]; }
+	for( int m=1; m < length ; m++ )
+	{
+		double* pm = p + m*voxel_jump; 
+		for( int q=0; q < number_of_substrates ; q++ )
+		{
+			pm[q] += constant1[q] * pm[q-voxel_jump]; 
+			pm[q] /= denom[m][q]; 
+		}
+	}
+	for( int m=length-2; m >= 0 ; m-- )
+	{
+		double* pm = p + m*voxel_jump; 
+		for( int q=0; q < number_of_substrates ; q++ )
+		{ pm[q] -= c[m][q] * pm[q+voxel_jump]; }
+	}
+	return; 
+}
+
+void diffusion_decay_solver__constant_coefficients_LOD_3D_MPI( Microenvironment& M, double dt )
+{
+	MPI_Slab_Decomposition& D = mpi_slab_decomposition; 
+	if( D.communicator == MPI_COMM_NULL )
+	{
+		std::cout << "Error: call setup_mpi_slab_decomposition before using " << __FUNCTION__ << std::endl; 
+		exit(-1); 
+	}
+	if( M.multirate_time_stepping_enabled() )
+	{
+		std::cout << "Error: " << __FUNCTION__ << " does not support multi-rate time stepping." << std::endl; 
+		exit(-1); 
+	}
+	if( M.quasi_steady_state_enabled() )
+	{
+		// the quasi-steady-state solve is serial, and would treat the slab faces as no-flux 
+		std::cout << "Error: " << __FUNCTION__ << " does not support quasi-steady-state substrates." << std::endl; 
+		exit(-1); 
+	}
+	
+	int nx = M.mesh.x_coordinates.size(); 
+	int ny = M.mesh.y_coordinates.size(); 
+	int nz = D.global_z_voxels; 
+	int nzl = D.z_slab_size_here(); 
+	int number_of_substrates = M.number_of_densities(); 
+	
+	if( D.thomas_dt != dt || (int) D.thomas_constant1.size() != number_of_substrates )
+	{
+		if( D.rank == 0 )
+		{
+			std::cout << std::endl << "Using method " << __FUNCTION__ << " (3-D LOD with Thomas Algorithm, " 
+				<< D.number_of_ranks << " MPI ranks) ... " << std::endl << std::endl;  
+		}
+		D.thomas_constant1 = M.diffusion_coefficients; // dt*D/dx^2 
+		D.thomas_constant1 *= dt; 
+		D.thomas_constant1 /= M.mesh.dx; 
+		D.thomas_constant1 /= M.mesh.dx; 
+		std::vector<double> constant2 = M.decay_rates; // (1/3)* dt*lambda 
+		constant2 *= dt; 
+		constant2 /= 3.0; 
+		
+		setup_thomas_coefficients( nx , D.thomas_constant1 , constant2 , D.thomas_denomx , D.thomas_cx ); 
+		setup_thomas_coefficients( ny , D.thomas_constant1 , constant2 , D.thomas_denomy , D.thomas_cy ); 
+		setup_thomas_coefficients( nz , D.thomas_constant1 , constant2 , D.thomas_denomz , D.thomas_cz ); 
+		D.thomas_dt = dt; 
+	}
+	
+	// work on voxel-major contiguous storage 
+	if( !M.contiguous_density_storage_enabled() || M.density_storage_layout() != voxel_major_density_layout )
+	{ M.enable_contiguous_density_storage( voxel_major_density_layout ); }
+	M.copy_densities_to_contiguous_storage(); 
+	double* pData = M.contiguous_density_data(); 
+	int i_jump = number_of_substrates; 
+	int j_jump = i_jump * nx; 
+	int k_jump = j_jump * ny; 
+	
+	// x-diffusion (local) 
+	
+	M.apply_dirichlet_conditions_to_contiguous_storage(); 
+	#pragma omp parallel for 
+	for( int line=0; line < ny*nzl ; line++ )
+	{ thomas_solve_line( pData + line*j_jump , nx , i_jump , number_of_substrates , D.thomas_constant1 , D.thomas_denomx , D.thomas_cx ); }
+	
+	// y-diffusion (local) 
+	
+	M.apply_dirichlet_conditions_to_contiguous_storage(); 
+	#pragma omp parallel for 
+	for( int line=0; line < nx*nzl ; line++ )
+	{
+		int i = line % nx; 
+		int k = line / nx; 
+		thomas_solve_line( pData + i*i_jump + k*k_jump , ny , j_jump , number_of_substrates , D.thomas_constant1 , D.thomas_denomy , D.thomas_cy ); 
+	}
+	
+	// z-diffusion: transpose z-slabs to y-slabs, solve whole z-lines, transpose back 
+	
+	M.apply_dirichlet_conditions_to_contiguous_storage(); 
+	
+	int P = D.number_of_ranks; 
+	int nyl = D.y_slab_size[D.rank]; 
+	D.send_counts.assign( P , 0 ); 
+	D.send_offsets.assign( P , 0 ); 
+	D.receive_counts.assign( P , 0 ); 
+	D.receive_offsets.assign( P , 0 ); 
+	int send_offset = 0; 
+	int receive_offset = 0; 
+	for( int r=0; r < P ; r++ )
+	{
+		D.send_counts[r] = nzl * D.y_slab_size[r] * nx * number_of_substrates; 
+		D.receive_counts[r] = D.z_slab_size[r] * nyl * nx * number_of_substrates; 
+		D.send_offsets[r] = send_offset; 
+		D.receive_offsets[r] = receive_offset; 
+		send_offset += D.send_counts[r]; 
+		receive_offset += D.receive_counts[r]; 
+	}
+	D.send_buffer.resize( nzl * ny * nx * number_of_substrates ); 
+	D.receive_buffer.resize( nz * nyl * nx * number_of_substrates ); 
+	D.z_lines.resize( nz * nyl * nx * number_of_substrates ); 
+	
+	// pack: for each destination, its y-range of every local plane 
+	int plane_row = nx * number_of_substrates; 
+	for( int r=0; r < P ; r++ )
+	{
+		double* pOut = D.send_buffer.data() + D.send_offsets[r]; 
+		for( int k=0; k < nzl ; k++ )
+		{
+			for( int j=D.y_slab_start[r]; j < D.y_slab_start[r] + D.y_slab_size[r] ; j++ )
+			{
+				std::memcpy( pOut , pData + j*j_jump + k*k_jump , plane_row*sizeof(double) ); 
+				pOut += plane_row; 
+			}
+		}
+	}
+	MPI_Alltoallv( D.send_buffer.data() , D.send_counts.data() , D.send_offsets.data() , MPI_DOUBLE , 
+		D.receive_buffer.data() , D.receive_counts.data() , D.receive_offsets.data() , MPI_DOUBLE , D.communicator ); 
+	
+	// unpack to z-lines: voxel (i,j,k) of the y-slab is at ((j*nz + k)*nx + i)*number_of_substrates 
+	int line_k_jump = plane_row; 
+	int line_j_jump = nz * plane_row; 
+	for( int r=0; r < P ; r++ )
+	{
+		double* pIn = D.receive_buffer.data() + D.receive_offsets[r]; 
+		for( int k=D.z_slab_start[r]; k < D.z_slab_start[r] + D.z_slab_size[r] ; k++ )
+		{
+			for( int j=0; j < nyl ; j++ )
+			{
+				std::memcpy( D.z_lines.data() + j*line_j_jump + k*line_k_jump , pIn , plane_row*sizeof(double) ); 
+				pIn += plane_row; 
+			}
+		}
+	}
+	
+	#pragma omp parallel for 
+	for( int line=0; line < nx*nyl ; line++ )
+	{
+		int i = line % nx; 
+		int j = line / nx; 
+		thomas_solve_line( D.z_lines.data() + i*i_jump + j*line_j_jump , nz , line_k_jump , number_of_substrates , 
+			D.thomas_constant1 , D.thomas_denomz , D.thomas_cz ); 
+	}
+	
+	// and back: the same messages in the other direction 
+	for( int r=0; r < P ; r++ )
+	{
+		double* pOut = D.receive_buffer.data() + D.receive_offsets[r]; 
+		for( int k=D.z_slab_start[r]; k < D.z_slab_start[r] + D.z_slab_size[r] ; k++ )
+		{
+			for( int j=0; j < nyl ; j++ )
+			{
+				std::memcpy( pOut , D.z_lines.data() + j*line_j_jump + k*line_k_jump , plane_row*sizeof(double) ); 
+				pOut += plane_row; 
+			}
+		}
+	}
+	MPI_Alltoallv( D.receive_buffer.data() , D.receive_counts.data() , D.receive_offsets.data() , MPI_DOUBLE , 
+		D.send_buffer.data() , D.send_counts.data() , D.send_offsets.data() , MPI_DOUBLE , D.communicator ); 
+	for( int r=0; r < P ; r++ )
+	{
+		double* pIn = D.send_buffer.data() + D.send_offsets[r]; 
+		for( int k=0; k < nzl ; k++ )
+		{
+			for( int j=D.y_slab_start[r]; j < D.y_slab_start[r] + D.y_slab_size[r] ; j++ )
+			{
+				std::memcpy( pData + j*j_jump + k*k_jump , pIn , plane_row*sizeof(double) ); 
+				pIn += plane_row; 
+			}
+		}
+	}
+	
+	M.apply_dirichlet_conditions_to_contiguous_storage(); 
+	M.copy_densities_from_contiguous_storage(); 
+	return; 
+}
+
+void exchange_ghost_layers_mpi( Microenvironment& M , std::vector<double>& lower_plane , std::vector<double>& upper_plane )
+{
+	MPI_Slab_Decomposition& D = mpi_slab_decomposition; 
+	int nx = M.mesh.x_coordinates.size(); 
+	int ny = M.mesh.y_coordinates.size(); 
+	int nzl = D.z_slab_size_here(); 
+	int number_of_substrates = M.number_of_densities(); 
+	int plane_size = nx * ny * number_of_substrates; 
+	
+	int below = ( D.rank > 0 ) ? D.rank-1 : MPI_PROC_NULL; 
+	int above = ( D.rank < D.number_of_ranks-1 ) ? D.rank+1 : MPI_PROC_NULL; 
+	
+	std::vector<double> bottom( plane_size ); 
+	std::vector<double> top( plane_size ); 
+	for( int n=0; n < nx*ny ; n++ )
+	{
+		std::memcpy( bottom.data() + n*number_of_substrates , M.density_vector( n ).data() , number_of_substrates*sizeof(double) ); 
+		std::memcpy( top.data() + n*number_of_substrates , M.density_vector( n + (nzl-1)*nx*ny ).data() , number_of_substrates*sizeof(double) ); 
+	}
+	
+	lower_plane.assign( below == MPI_PROC_NULL ? 0 : plane_size , 0.0 ); 
+	upper_plane.assign( above == MPI_PROC_NULL ? 0 : plane_size , 0.0 ); 
+	// send the top plane up while receiving the lower ghost plane, then the reverse 
+	MPI_Sendrecv( top.data() , above == MPI_PROC_NULL ? 0 : plane_size , MPI_DOUBLE , above , 0 , 
+		lower_plane.data() , lower_plane.size() , MPI_DOUBLE , below , 0 , D.communicator , MPI_STATUS_IGNORE ); 
+	MPI_Sendrecv( bottom.data() , below == MPI_PROC_NULL ? 0 : plane_size , MPI_DOUBLE , below , 1 , 
+		upper_plane.data() , upper_plane.size() , MPI_DOUBLE , above , 1 , D.communicator , MPI_STATUS_IGNORE ); 
+	return; 
+}
+
+void compute_all_gradient_vectors_mpi( Microenvironment& M )
+{
+	MPI_Slab_Decomposition& D = mpi_slab_decomposition; 
+	// the serial LOD setup is never run on a distributed mesh 
+	M.thomas_i_jump = 1; 
+	M.thomas_j_jump = M.mesh.x_coordinates.size(); 
+	M.thomas_k_jump = M.thomas_j_jump * M.mesh.y_coordinates.size(); 
+	M.compute_all_gradient_vectors(); 
+	
+	std::vector<double> lower_plane; 
+	std::vector<double> upper_plane; 
+	exchange_ghost_layers_mpi( M , lower_plane , upper_plane ); 
+	
+	// redo the z-derivatives on the slab faces that border another rank 
+	int nx = M.mesh.x_coordinates.size(); 
+	int ny = M.mesh.y_coordinates.size(); 
+	int nzl = D.z_slab_size_here(); 
+	int number_of_substrates = M.number_of_densities(); 
+	double dz = M.mesh.dz; 
+	
+	std::vector<int> planes; 
+	if( lower_plane.size() > 0 )
+	{ planes.push_back( 0 ); }
+	if( upper_plane.size() > 0 && ( nzl > 1 || planes.size() == 0 ) )
+	{ planes.push_back( nzl-1 ); }
+	
+	for( unsigned int p=0; p < planes.size() ; p++ )
+	{
+		int k = planes[p]; 
+		#pragma omp parallel for 
+		for( int m=0; m < nx*ny ; m++ )
+		{
+			int n = m + k*nx*ny; 
+			if( ( M.gradient_vector_computed[n] & 2 ) == 0 )
+			{
+				M.assemble_gradient_vector( n ); 
+				M.gradient_vector_computed[n] = 2; 
+			}
+			for( int q=0; q < number_of_substrates ; q++ )
+			{
+				const double* pBelow = NULL; 
+				const double* pAbove = NULL; 
+				if( k > 0 )
+				{ pBelow = &M.density_vector( n - nx*ny )[q]; }
+				else if( lower_plane.size() > 0 )
+				{ pBelow = &lower_plane[ m*number_of_substrates + q ]; }
+				if( k < nzl-1 )
+				{ pAbove = &M.density_vector( n + nx*ny )[q]; }
+				else if( upper_plane.size() > 0 )
+				{ pAbove = &upper_plane[ m*number_of_substrates + q ]; }
+				
+				// same differences as compute_all_gradient_vectors 
+				double rho = M.density_vector( n )[q]; 
+				double value = 0.0; 
+				if( pBelow && pAbove )
+				{ value = ( *pAbove - *pBelow ) / ( 2.0 * dz ); }
+				else if( pAbove )
+				{ value = ( *pAbove - rho ) / dz; }
+				else if( pBelow )
+				{ value = ( rho - *pBelow ) / dz; }
+				
+				M.gradient_vectors[n][q][2] = value; 
+				if( M.gradient_storage_up_to_date && M.gradient_storage_slot[q] >= 0 )
+				{ M.gradient_storage[ (3*M.gradient_storage_slot[q]+2)*M.gradient_storage_stride + n ] = value; }
+			}
+		}
+	}
+	return; 
+}
+
+void gather_densities_mpi( Microenvironment& M , std::vector<double>& global_densities , int root )
+{
+	MPI_Slab_Decomposition& D = mpi_slab_decomposition; 
+	int number_of_substrates = M.number_of_densities(); 
+	int plane_size = M.mesh.x_coordinates.size() * M.mesh.y_coordinates.size() * number_of_substrates; 
+	
+	// a z-slab is a contiguous range of global voxel indices 
+	std::vector<double> local( M.number_of_voxels() * number_of_substrates ); 
+	for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+	{ std::memcpy( local.data() + n*number_of_substrates , M.density_vector( n ).data() , number_of_substrates*sizeof(double) ); }
+	
+	std::vector<int> counts( D.number_of_ranks ); 
+	std::vector<int> offsets( D.number_of_ranks ); 
+	for( int r=0; r < D.number_of_ranks ; r++ )
+	{
+		counts[r] = D.z_slab_size[r] * plane_size; 
+		offsets[r] = D.z_slab_start[r] * plane_size; 
+	}
+	if( D.rank == root )
+	{ global_densities.assign( D.global_z_voxels * plane_size , 0.0 ); }
+	MPI_Gatherv( local.data() , local.size() , MPI_DOUBLE , global_densities.data() , counts.data() , offsets.data() , 
+		MPI_DOUBLE , root , D.communicator ); 
+	return; 
+}
+
+};
+
+#endif
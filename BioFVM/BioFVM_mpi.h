@@ -0,0 +1,135 @@
+/*
+#############################################################################
+# If you use BioFVM in your project, please cite BioFVM and the version     #
+# number, such as below:                                                    #
+#                                                                           #
+# We solved the diffusion equations using BioFVM (Version 1.1.7) [1]        #
+#                                                                           #
+# [1] A. Ghaffarizadeh, S.H. Friedman, and P. Macklin, BioFVM: an efficient #
+#    parallelized diffusive transport solver for 3-D biological simulations,#
+#    Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730 #
+#                                                                           #
+#############################################################################
+#                                                                           #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)   #
+#                                                                           #
+# Copyright (c) 2015-2025, Paul Macklin and the BioFVM Project              #
+# All rights reserved.                                                      #
+#                                                                           #
+# Redistribution and use in source and binary forms, with or without        #
+# modification, are permitted provided that the following conditions are    #
+# met:                                                                      #
+#                                                                           #
+# 1. Redistributions of source code must retain the above copyright notice, #
+# this list of conditions and the following disclaimer.                     #
+#                                                                           #
+# 2. Redistributions in binary form must reproduce the above copyright      #
+# notice, this list of conditions and the following disclaimer in the       #
+# documentation and/or other materials provided with the distribution.      #
+#                                                                           #
+# 3. Neither the name of the copyright holder nor the names of its          #
+# contributors may be used to endorse or promote products derived from this #
+# software without specific prior written permission.                       #
+#                                                                           #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS       #
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED #
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A           #
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER #
+# OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,  #
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,       #
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR        #
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF    #
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING      #
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS        #
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.              #
+#                                                                           #
+#############################################################################
+*/
+
+#ifndef __BioFVM_mpi_h__
+#define __BioFVM_mpi_h__
+
+/* Distributed-memory (MPI) slab decomposition for the 3-D LOD solver. Compile with 
+   -DBIOFVM_MPI (e.g., with mpicxx) to enable; without it this header is empty. 
+   
+   Each rank's Microenvironment holds one z-slab of the global mesh (all of x and y), 
+   so the x- and y-sweeps are local. For the z-sweeps, the densities are transposed 
+   (MPI_Alltoallv) to y-slabs that hold whole z-lines, solved, and transposed back. 
+   Per line, the arithmetic is that of diffusion_decay_solver__constant_coefficients_LOD_3D. */ 
+
+#ifdef BIOFVM_MPI
+
+#include <mpi.h>
+#include <vector>
+
+#include "BioFVM_microenvironment.h"
+
+namespace BioFVM{
+
+class MPI_Slab_Decomposition
+{
+ public:
+	MPI_Comm communicator; 
+	int rank; 
+	int number_of_ranks; 
+	
+	int global_x_voxels; 
+	int global_y_voxels; 
+	int global_z_voxels; 
+	double global_z_start; 
+	double global_z_end; 
+	
+	/*! z-slab of each rank (its Microenvironment) and y-slab of each rank (during the z-sweeps) */ 
+	std::vector<int> z_slab_start; 
+	std::vector<int> z_slab_size; 
+	std::vector<int> y_slab_start; 
+	std::vector<int> y_slab_size; 
+	
+	/*! Thomas coefficients, same as in the serial LOD solver (z uses the global mesh) */ 
+	double thomas_dt; 
+	std::vector<double> thomas_constant1; 
+	std::vector< std::vector<double> > thomas_denomx, thomas_cx; 
+	std::vector< std::vector<double> > thomas_denomy, thomas_cy; 
+	std::vector< std::vector<double> > thomas_denomz, thomas_cz; 
+	
+	std::vector<double> send_buffer; 
+	std::vector<double> receive_buffer; 
+	std::vector<double> z_lines; 
+	std::vector<int> send_counts, send_offsets, receive_counts, receive_offsets; 
+	
+	MPI_Slab_Decomposition(); 
+	
+	int z_slab_start_here( void ); 
+	int z_slab_size_here( void ); 
+}; 
+
+extern MPI_Slab_Decomposition mpi_slab_decomposition; 
+
+/*! split [z_start,z_end] into z-slabs across the ranks of communicator, resize M to this 
+    rank's slab, and register diffusion_decay_solver__constant_coefficients_LOD_3D_MPI */ 
+void setup_mpi_slab_decomposition( Microenvironment& M , MPI_Comm communicator , 
+	double x_start, double x_end, double y_start, double y_end, double z_start, double z_end , 
+	double dx, double dy, double dz ); 
+
+/*! true if the (local) voxel lies on the outer boundary of the global domain */ 
+bool mpi_voxel_on_outer_boundary( Microenvironment& M , int voxel_index ); 
+
+/*! 3-D LOD across the ranks. Does not support multi-rate time stepping, quasi-steady-state 
+    substrates, or the fused bulk source/sink update. */ 
+void diffusion_decay_solver__constant_coefficients_LOD_3D_MPI( Microenvironment& M, double dt ); 
+
+/*! densities of the z-planes just below and just above this rank's slab (empty at the 
+    global zmin/zmax). Each plane is voxel-major: [ (j*nx + i)*number_of_densities + q ] */ 
+void exchange_ghost_layers_mpi( Microenvironment& M , std::vector<double>& lower_plane , std::vector<double>& upper_plane ); 
+
+/*! compute_all_gradient_vectors, with centered z-differences across the slab boundaries */ 
+void compute_all_gradient_vectors_mpi( Microenvironment& M ); 
+
+/*! gather all densities on root, voxel-major in global voxel order */ 
+void gather_densities_mpi( Microenvironment& M , std::vector<double>& global_densities , int root ); 
+
+};
+
+#endif
+
+#endif
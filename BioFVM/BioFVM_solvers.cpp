@@ -48,6 +48,7 @@
 
 #include "BioFVM_solvers.h" 
 #include "BioFVM_vector.h" 
+#include "BioFVM_basic_agent.h" 
 
 #include <iostream>
 #include <omp.h>
@@ -93,6 +94,343 @@ void diffusion_decay_solver__constant_coefficients_explicit_uniform_mesh( Microe
 	return; 
 }
 
+// number of lines solved together by the vectorized Thomas sweeps 
+// (8 doubles: one AVX-512 register, or two AVX2 registers) 
+static const int thomas_simd_lanes = 8; 
+
+// Thomas solve of row_length independent lines at once. Line i is p[i], p[i+row_jump], ... 
+// (number_of_rows entries), so each step of the recurrence is a SIMD operation 
+// across the row. Coefficients are those of substrate q. 
+static void thomas_solve_rows( double* p , int row_length , int number_of_rows , int row_jump , 
+	double c1 , const std::vector< std::vector<double> >& denom , 
+	const std::vector< std::vector<double> >& c , int q )
+{
+	double d = denom[0][q]; 
+	#pragma omp simd 
+	for( int i=0; i < row_length ; i++ )
+	{ p[i] /= d; }
+	
+	for( int r=1; r < number_of_rows ; r++ )
+	{
+		double* row = p + r*row_jump; 
+		const double* previous = row - row_jump; 
+		d = denom[r][q]; 
+		#pragma omp simd 
+		for( int i=0; i < row_length ; i++ )
+		{
+			row[i] += c1 * previous[i]; 
+			row[i] /= d; 
+		}
+	}
+	
+	for( int r = number_of_rows-2; r >= 0 ; r-- )
+	{
+		double* row = p + r*row_jump; 
+		const double* next = row + row_jump; 
+		double cr = c[r][q]; 
+		#pragma omp simd 
+		for( int i=0; i < row_length ; i++ )
+		{ row[i] -= cr * next[i]; }
+	}
+	return; 
+}
+
+// Vectorized Thomas sweeps on substrate-major storage. x-lines are contiguous, so 
+// batches of thomas_simd_lanes neighboring x-lines are transposed into a small 
+// [i][lane] buffer and solved together. For y- and z-lines, neighboring lines 
+// (adjacent i) are already adjacent in memory and are solved in place, in 
+// blocks of adjacent i-columns (see thomas_sweeps_on_contiguous_storage). 
+static void thomas_x_sweep_vectorized( double* pData , const std::vector< std::vector<double> >& densities , 
+	int nx , int number_of_lines , int number_of_substrates , int substrate_jump , const std::vector<char>& skip , 
+	const double* bulk_source , const double* bulk_denominator , const std::vector<double>& c1 , 
+	const std::vector< std::vector<double> >& denom , const std::vector< std::vector<double> >& c )
+{
+	int number_of_batches = ( number_of_lines + thomas_simd_lanes - 1 ) / thomas_simd_lanes; 
+	#pragma omp parallel 
+	{
+		aligned_double_vector buffer( nx*thomas_simd_lanes , 0.0 ); 
+		double* b = buffer.data(); 
+		
+		#pragma omp for 
+		for( int n=0; n < number_of_substrates*number_of_batches ; n++ )
+		{
+			int q = n / number_of_batches; 
+			if( skip[q] )
+			{ continue; }
+			int first_line = ( n % number_of_batches ) * thomas_simd_lanes; 
+			int lanes = number_of_lines - first_line; 
+			if( lanes > thomas_simd_lanes )
+			{ lanes = thomas_simd_lanes; }
+			
+			// x-line l is voxels l*nx, ..., l*nx+nx-1, and starts at l*nx in each substrate block. 
+			// The first sweep loads straight from the per-voxel vectors. 
+			const std::vector<double>* v = densities.data() + first_line*nx; 
+			double* p = pData + q*substrate_jump + first_line*nx; 
+			if( bulk_source )
+			{
+				// fused bulk source/sink update (see Microenvironment::simulate_bulk_sources_and_sinks)
+				const double* s = bulk_source + ( p - pData ); 
+				const double* d = bulk_denominator + ( p - pData ); 
+				for( int l=0; l < lanes ; l++ )
+				{
+					for( int i=0; i < nx ; i++ )
+					{ b[i*thomas_simd_lanes+l] = ( v[l*nx+i][q] + s[l*nx+i] ) / d[l*nx+i]; }
+				}
+			}
+			else
+			{
+				for( int l=0; l < lanes ; l++ )
+				{
+					for( int i=0; i < nx ; i++ )
+					{ b[i*thomas_simd_lanes+l] = v[l*nx+i][q]; }
+				}
+			}
+			
+			thomas_solve_rows( b , thomas_simd_lanes , nx , thomas_simd_lanes , c1[q] , denom , c , q ); 
+			
+			for( int l=0; l < lanes ; l++ )
+			{
+				for( int i=0; i < nx ; i++ )
+				{ p[l*nx+i] = b[i*thomas_simd_lanes+l]; }
+			}
+		}
+	}
+	return; 
+}
+
+// store a solved tile of the last sweep back into the per-voxel vectors while it is in cache 
+static void store_rows( const double* p , std::vector< std::vector<double> >& densities , int first_voxel , 
+	int row_length , int number_of_rows , int row_jump , int q )
+{
+	for( int r=0; r < number_of_rows ; r++ )
+	{
+		for( int i=0; i < row_length ; i++ )
+		{ densities[first_voxel + r*row_jump + i][q] = p[r*row_jump + i]; }
+	}
+	return; 
+}
+
+// Thomas sweeps of the LOD solvers, performed on the contiguous density storage 
+// instead of the per-voxel vectors. Same arithmetic as the per-voxel code (so 
+// results match), but without a pointer dereference per voxel in the inner sweeps. 
+// The x-sweep loads from the per-voxel vectors and the last sweep stores back into 
+// them, so there is no separate copy pass over the whole mesh. 
+void thomas_sweeps_on_contiguous_storage( Microenvironment& M , int dimensions )
+{
+	int nx = M.mesh.x_coordinates.size(); 
+	int ny = M.mesh.y_coordinates.size(); 
+	int nz = M.mesh.z_coordinates.size(); 
+	int number_of_substrates = M.number_of_densities(); 
+	
+	M.resize_contiguous_storage(); 
+	double* pData = M.contiguous_density_data(); 
+	std::vector< std::vector<double> >& densities = *M.p_density_vectors; 
+	
+	// voxel-major: neighboring voxels are number_of_substrates apart, substrates are adjacent
+	// substrate-major: neighboring voxels are adjacent, substrates are one (padded) mesh apart 
+	int voxel_jump = number_of_substrates; 
+	int substrate_jump = 1; 
+	if( M.density_storage_layout() == substrate_major_density_layout )
+	{
+		voxel_jump = 1; 
+		substrate_jump = M.density_storage_stride(); 
+	}
+	int i_jump = voxel_jump; 
+	int j_jump = voxel_jump * nx; 
+	int k_jump = voxel_jump * nx * ny; 
+	
+	bool vectorized = M.vectorized_thomas_sweeps_enabled() && 
+		M.density_storage_layout() == substrate_major_density_layout; 
+	
+	// the vectorized y- and z-sweeps work on tiles of block_size adjacent i-columns, 
+	// so a tile's lines stay in cache between the forward and backward passes 
+	int block_size = M.thomas_sweep_block_size(); 
+	if( block_size <= 0 || block_size > nx )
+	{ block_size = nx; }
+	int number_of_blocks = ( nx + block_size - 1 ) / block_size; 
+	
+	// with multi-rate time stepping, substrates that are not due keep their values; 
+	// quasi-steady substrates are solved separately (see quasi_steady_state_solver) 
+	std::vector<char> skip( number_of_substrates , 0 ); 
+	for( int q=0; q < number_of_substrates ; q++ )
+	{ skip[q] = !M.substrate_is_advanced( q ); }
+	
+	// pending bulk sources/sinks are fused into the forward pass of the x-sweep 
+	const double* bulk_source = NULL; 
+	const double* bulk_denominator = NULL; 
+	if( M.bulk_source_sink_pending )
+	{
+		M.update_fused_bulk_coefficients(); 
+		bulk_source = M.fused_bulk_source.data(); 
+		bulk_denominator = M.fused_bulk_denominator.data(); 
+		M.bulk_source_sink_pending = false; 
+	}
+	
+	// x-diffusion (loads from the per-voxel vectors) 
+	
+	M.apply_dirichlet_conditions(); 
+	if( vectorized )
+	{
+		thomas_x_sweep_vectorized( pData , densities , nx , ny*nz , number_of_substrates , substrate_jump , skip , 
+			bulk_source , bulk_denominator , M.thomas_constant1 , M.thomas_denomx , M.thomas_cx ); 
+	}
+	else
+	{
+		#pragma omp parallel for 
+		for( int k=0; k < nz ; k++ )
+		{
+			for( int j=0; j < ny ; j++ )
+			{
+				for( int q=0; q < number_of_substrates ; q++ )
+				{
+					if( skip[q] )
+					{ continue; }
+					double* p = pData + q*substrate_jump + j*j_jump + k*k_jump; 
+					const std::vector<double>* v = densities.data() + j*nx + k*nx*ny; 
+					const double c1 = M.thomas_constant1[q]; 
+
+					if( bulk_source )
+					{
+						const double* s = bulk_source + ( p - pData ); 
+						const double* d = bulk_denominator + ( p - pData ); 
+						p[0] = ( v[0][q] + s[0] ) / d[0]; 
+						p[0] /= M.thomas_denomx[0][q]; 
+						for( int i=1; i < nx ; i++ )
+						{
+							p[i*i_jump] = ( v[i][q] + s[i*i_jump] ) / d[i*i_jump]; 
+							p[i*i_jump] += c1 * p[(i-1)*i_jump]; 
+							p[i*i_jump] /= M.thomas_denomx[i][q]; 
+						}
+					}
+					else
+					{
+						p[0] = v[0][q]; 
+						p[0] /= M.thomas_denomx[0][q]; 
+						for( int i=1; i < nx ; i++ )
+						{
+							p[i*i_jump] = v[i][q]; 
+							p[i*i_jump] += c1 * p[(i-1)*i_jump]; 
+							p[i*i_jump] /= M.thomas_denomx[i][q]; 
+						}
+					}
+					for( int i = nx-2 ; i >= 0 ; i-- )
+					{ p[i*i_jump] -= M.thomas_cx[i][q] * p[(i+1)*i_jump]; }
+				}
+			}
+		}
+	}
+	
+	// y-diffusion 
+	
+	M.apply_dirichlet_conditions_to_contiguous_storage(); 
+	if( vectorized )
+	{
+		#pragma omp parallel for 
+		for( int n=0; n < number_of_substrates*nz*number_of_blocks ; n++ )
+		{
+			int q = n / (nz*number_of_blocks); 
+			if( skip[q] )
+			{ continue; }
+			int k = (n / number_of_blocks) % nz; 
+			int i = (n % number_of_blocks) * block_size; 
+			int width = ( i + block_size <= nx ) ? block_size : nx - i; 
+			double* p = pData + q*substrate_jump + i + k*k_jump; 
+			thomas_solve_rows( p , width , ny , j_jump , 
+				M.thomas_constant1[q] , M.thomas_denomy , M.thomas_cy , q ); 
+			if( dimensions != 3 )
+			{ store_rows( p , densities , i + k*nx*ny , width , ny , nx , q ); }
+		}
+	}
+	else
+	{
+		#pragma omp parallel for 
+		for( int k=0; k < nz ; k++ )
+		{
+			for( int i=0; i < nx ; i++ )
+			{
+				for( int q=0; q < number_of_substrates ; q++ )
+				{
+					if( skip[q] )
+					{ continue; }
+					double* p = pData + q*substrate_jump + i*i_jump + k*k_jump; 
+					const double c1 = M.thomas_constant1[q]; 
+
+					p[0] /= M.thomas_denomy[0][q]; 
+					for( int j=1; j < ny ; j++ )
+					{
+						p[j*j_jump] += c1 * p[(j-1)*j_jump]; 
+						p[j*j_jump] /= M.thomas_denomy[j][q]; 
+					}
+					for( int j = ny-2 ; j >= 0 ; j-- )
+					{ p[j*j_jump] -= M.thomas_cy[j][q] * p[(j+1)*j_jump]; }
+					if( dimensions != 3 )
+					{
+						for( int j=0; j < ny ; j++ )
+						{ densities[i + j*nx + k*nx*ny][q] = p[j*j_jump]; }
+					}
+				}
+			}
+		}
+	}
+	
+	// z-diffusion 
+	
+	if( dimensions == 3 )
+	{
+		M.apply_dirichlet_conditions_to_contiguous_storage(); 
+		if( vectorized )
+		{
+			#pragma omp parallel for 
+			for( int n=0; n < number_of_substrates*ny*number_of_blocks ; n++ )
+			{
+				int q = n / (ny*number_of_blocks); 
+				if( skip[q] )
+				{ continue; }
+				int j = (n / number_of_blocks) % ny; 
+				int i = (n % number_of_blocks) * block_size; 
+				int width = ( i + block_size <= nx ) ? block_size : nx - i; 
+				double* p = pData + q*substrate_jump + i + j*j_jump; 
+				thomas_solve_rows( p , width , nz , k_jump , 
+					M.thomas_constant1[q] , M.thomas_denomz , M.thomas_cz , q ); 
+				store_rows( p , densities , i + j*nx , width , nz , nx*ny , q ); 
+			}
+		}
+		else
+		{
+			#pragma omp parallel for 
+			for( int j=0; j < ny ; j++ )
+			{
+				for( int i=0; i < nx ; i++ )
+				{
+					for( int q=0; q < number_of_substrates ; q++ )
+					{
+						if( skip[q] )
+						{ continue; }
+						double* p = pData + q*substrate_jump + i*i_jump + j*j_jump; 
+						const double c1 = M.thomas_constant1[q]; 
+
+						p[0] /= M.thomas_denomz[0][q]; 
+						for( int k=1; k < nz ; k++ )
+						{
+							p[k*k_jump] += c1 * p[(k-1)*k_jump]; 
+							p[k*k_jump] /= M.thomas_denomz[k][q]; 
+						}
+						for( int k = nz-2 ; k >= 0 ; k-- )
+						{ p[k*k_jump] -= M.thomas_cz[k][q] * p[(k+1)*k_jump]; }
+						for( int k=0; k < nz ; k++ )
+						{ densities[i + j*nx + k*nx*ny][q] = p[k*k_jump]; }
+					}
+				}
+			}
+		}
+	}
+	
+	// the last sweep stored the results in the per-voxel vectors 
+	M.apply_dirichlet_conditions(); 
+	
+	return; 
+}
+
 void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M, double dt )
 {
 	if( M.mesh.regular_mesh == false || M.mesh.Cartesian_mesh == false )
@@ -121,20 +459,23 @@ void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M,
 		M.thomas_j_jump = M.mesh.x_coordinates.size(); 
 		M.thomas_k_jump = M.thomas_j_jump * M.mesh.y_coordinates.size(); 
 
+		// each substrate advances by its own multiple of dt (see multi-rate time stepping) 
+		std::vector<double> substrate_dt = M.substrate_time_steps( dt ); 
+
 		M.thomas_constant1 =  M.diffusion_coefficients; // dt*D/dx^2 
 		M.thomas_constant1a = M.zero; // -dt*D/dx^2; 
 		M.thomas_constant2 =  M.decay_rates; // (1/3)* dt*lambda 
 		M.thomas_constant3 = M.one; // 1 + 2*constant1 + constant2; 
 		M.thomas_constant3a = M.one; // 1 + constant1 + constant2; 		
 			
-		M.thomas_constant1 *= dt; 
+		M.thomas_constant1 *= substrate_dt; 
 		M.thomas_constant1 /= M.mesh.dx; 
 		M.thomas_constant1 /= M.mesh.dx; 
 
 		M.thomas_constant1a = M.thomas_constant1; 
 		M.thomas_constant1a *= -1.0; 
 
-		M.thomas_constant2 *= dt; 
+		M.thomas_constant2 *= substrate_dt; 
 		M.thomas_constant2 /= 3.0; // for the LOD splitting of the source 
 
 		M.thomas_constant3 += M.thomas_constant1; 
@@ -191,6 +532,18 @@ void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M,
 		M.diffusion_solver_setup_done = true; 
 	}
 
+	// skipping substrates that are not due or quasi-steady, and fusing the bulk sources/sinks 
+	// into the first sweep, need the contiguous storage 
+	if( ( M.multirate_time_stepping_enabled() || M.quasi_steady_state_enabled() || M.bulk_source_sink_pending ) && 
+		!M.contiguous_density_storage_enabled() )
+	{ M.enable_contiguous_density_storage( substrate_major_density_layout ); }
+
+	if( M.contiguous_density_storage_enabled() )
+	{
+		thomas_sweeps_on_contiguous_storage( M , 3 ); 
+		return; 
+	}
+
 	// x-diffusion 
 	
 	M.apply_dirichlet_conditions();
@@ -324,20 +677,23 @@ void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& M,
 		M.thomas_i_jump = 1; 
 		M.thomas_j_jump = M.mesh.x_coordinates.size(); 
 
+		// each substrate advances by its own multiple of dt (see multi-rate time stepping) 
+		std::vector<double> substrate_dt = M.substrate_time_steps( dt ); 
+
 		M.thomas_constant1 =  M.diffusion_coefficients; //   dt*D/dx^2 
 		M.thomas_constant1a = M.zero; // -dt*D/dx^2; 
 		M.thomas_constant2 =  M.decay_rates; // (1/2)*dt*lambda 
 		M.thomas_constant3 = M.one; // 1 + 2*constant1 + constant2; 
 		M.thomas_constant3a = M.one; // 1 + constant1 + constant2; 
 		
-		M.thomas_constant1 *= dt; 
+		M.thomas_constant1 *= substrate_dt; 
 		M.thomas_constant1 /= M.mesh.dx; 
 		M.thomas_constant1 /= M.mesh.dx; 
 
 		M.thomas_constant1a = M.thomas_constant1; 
 		M.thomas_constant1a *= -1.0; 
 
-		M.thomas_constant2 *= dt; 
+		M.thomas_constant2 *= substrate_dt; 
 		M.thomas_constant2 *= 0.5; // for splitting via LOD
 
 		M.thomas_constant3 += M.thomas_constant1; 
@@ -380,6 +736,18 @@ void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& M,
 		M.diffusion_solver_setup_done = true; 
 	}
 
+	// skipping substrates that are not due or quasi-steady, and fusing the bulk sources/sinks 
+	// into the first sweep, need the contiguous storage 
+	if( ( M.multirate_time_stepping_enabled() || M.quasi_steady_state_enabled() || M.bulk_source_sink_pending ) && 
+		!M.contiguous_density_storage_enabled() )
+	{ M.enable_contiguous_density_storage( substrate_major_density_layout ); }
+
+	if( M.contiguous_density_storage_enabled() )
+	{
+		thomas_sweeps_on_contiguous_storage( M , 2 ); 
+		return; 
+	}
+
 	// set the pointer
 	
 	M.apply_dirichlet_conditions();
@@ -626,4 +994,247 @@ void diffusion_decay_solver__constant_coefficients_LOD_1D( Microenvironment& M,
 }
 
 
+
+// Quasi-steady-state solver for substrate q. Solves 
+//
+//    0 = D*Laplacian(rho) - lambda*rho - (U+S)(x)*rho + S(x)*T(x) + cell sources/sinks 
+//
+// with the same 7-point stencil, no-flux outer boundaries, and Dirichlet nodes as the 
+// LOD solvers. Cell terms are the rates behind Basic_Agent::set_internal_uptake_constants. 
+// Uses matrix-free conjugate gradients with a Jacobi preconditioner, started from the 
+// current field, so repeated solves on a slowly changing problem take few iterations. 
+
+// Ap = A*p on the free (non-Dirichlet) voxels; p is zero on the Dirichlet voxels 
+static void quasi_steady_state_operator( const std::vector<double>& p , std::vector<double>& Ap , 
+	const std::vector<double>& diagonal , const std::vector<char>& fixed , 
+	int nx , int ny , int nz , double cx , double cy , double cz )
+{
+	#pragma omp parallel for 
+	for( int k=0; k < nz ; k++ )
+	{
+		for( int j=0; j < ny ; j++ )
+		{
+			int n = (k*ny + j)*nx; 
+			for( int i=0; i < nx ; i++ , n++ )
+			{
+				if( fixed[n] )
+				{ Ap[n] = 0.0; continue; }
+				double out = diagonal[n] * p[n]; 
+				if( i > 0 ){ out -= cx*p[n-1]; }
+				if( i < nx-1 ){ out -= cx*p[n+1]; }
+				if( j > 0 ){ out -= cy*p[n-nx]; }
+				if( j < ny-1 ){ out -= cy*p[n+nx]; }
+				if( k > 0 ){ out -= cz*p[n-nx*ny]; }
+				if( k < nz-1 ){ out -= cz*p[n+nx*ny]; }
+				Ap[n] = out; 
+			}
+		}
+	}
+	return; 
+}
+
+static double quasi_steady_state_dot( const std::vector<double>& a , const std::vector<double>& b )
+{
+	double out = 0.0; 
+	#pragma omp parallel for reduction(+:out)
+	for( int n=0; n < (int) a.size() ; n++ )
+	{ out += a[n]*b[n]; }
+	return out; 
+}
+
+double quasi_steady_state_source_total( Microenvironment& M , int substrate_index )
+{
+	// total secretion, uptake, and export strength of the agents in M; used to 
+	// detect when the sources have changed enough to warrant a new solve 
+	int q = substrate_index; 
+	double out = 0.0; 
+	for( unsigned int a=0; a < all_basic_agents.size() ; a++ )
+	{
+		Basic_Agent* pA = all_basic_agents[a]; 
+		if( pA->is_active == false || pA->get_microenvironment() != &M || pA->get_current_voxel_index() < 0 )
+		{ continue; }
+		double volume = pA->get_total_volume(); 
+		out += volume * ( (*pA->secretion_rates)[q] * ( 1.0 + (*pA->saturation_densities)[q] ) + (*pA->uptake_rates)[q] ) 
+			+ fabs( (*pA->net_export_rates)[q] ); 
+	}
+	return out; 
+}
+
+int quasi_steady_state_solver( Microenvironment& M , int substrate_index )
+{
+	int q = substrate_index; 
+	int nx = M.mesh.x_coordinates.size(); 
+	int ny = M.mesh.y_coordinates.size(); 
+	int nz = M.mesh.z_coordinates.size(); 
+	int number_of_voxels = M.number_of_voxels(); 
+	
+	double cx = M.diffusion_coefficients[q] / ( M.mesh.dx * M.mesh.dx ); 
+	double cy = M.diffusion_coefficients[q] / ( M.mesh.dy * M.mesh.dy ); 
+	double cz = M.diffusion_coefficients[q] / ( M.mesh.dz * M.mesh.dz ); 
+	
+	// reaction terms: diagonal = lambda + bulk (U+S) + stencil, source = bulk S*T 
+	std::vector<double> diagonal( number_of_voxels , 0.0 ); 
+	std::vector<double> source( number_of_voxels , 0.0 ); 
+	#pragma omp parallel 
+	{
+		std::vector<double> supply( M.number_of_densities() , 0.0 ); 
+		std::vector<double> target( M.number_of_densities() , 0.0 ); 
+		std::vector<double> uptake( M.number_of_densities() , 0.0 ); 
+		
+		#pragma omp for 
+		for( int k=0; k < nz ; k++ )
+		{
+			for( int j=0; j < ny ; j++ )
+			{
+				int n = (k*ny + j)*nx; 
+				for( int i=0; i < nx ; i++ , n++ )
+				{
+					M.bulk_supply_rate_function( &M , n , &supply ); 
+					M.bulk_supply_target_densities_function( &M , n , &target ); 
+					M.bulk_uptake_rate_function( &M , n , &uptake ); 
+					
+					diagonal[n] = M.decay_rates[q] + supply[q] + uptake[q]; 
+					source[n] = supply[q] * target[q]; 
+					
+					if( i > 0 ){ diagonal[n] += cx; }
+					if( i < nx-1 ){ diagonal[n] += cx; }
+					if( j > 0 ){ diagonal[n] += cy; }
+					if( j < ny-1 ){ diagonal[n] += cy; }
+					if( k > 0 ){ diagonal[n] += cz; }
+					if( k < nz-1 ){ diagonal[n] += cz; }
+				}
+			}
+		}
+	}
+	
+	// cell terms (serial: several agents can share a voxel) 
+	double source_total = 0.0; 
+	for( unsigned int a=0; a < all_basic_agents.size() ; a++ )
+	{
+		Basic_Agent* pA = all_basic_agents[a]; 
+		int n = pA->get_current_voxel_index(); 
+		if( pA->is_active == false || pA->get_microenvironment() != &M || n < 0 )
+		{ continue; }
+		double volume = pA->get_total_volume(); 
+		double volume_ratio = volume / M.mesh.voxels[n].volume; 
+		double S = (*pA->secretion_rates)[q]; 
+		double T = (*pA->saturation_densities)[q]; 
+		double U = (*pA->uptake_rates)[q]; 
+		double E = (*pA->net_export_rates)[q]; 
+		
+		diagonal[n] += volume_ratio * ( S + U ); 
+		source[n] += volume_ratio * S * T + E / M.mesh.voxels[n].volume; 
+		source_total += volume * ( S * ( 1.0 + T ) + U ) + fabs( E ); 
+	}
+	M.quasi_steady_state_source_totals[q] = source_total; 
+	
+	// current field (initial guess), with the Dirichlet nodes held fixed 
+	std::vector<double> rho( number_of_voxels ); 
+	std::vector<char> fixed( number_of_voxels , 0 ); 
+	#pragma omp parallel for 
+	for( int n=0; n < number_of_voxels ; n++ )
+	{ rho[n] = (*M.p_density_vectors)[n][q]; }
+	
+	if( M.dirichlet_list_up_to_date == false )
+	{ M.rebuild_dirichlet_list(); }
+	for( unsigned int m=0; m < M.dirichlet_indices.size() ; m++ )
+	{
+		unsigned int start = m*M.dirichlet_packed_stride; 
+		if( M.dirichlet_packed_activation[start+q] == true )
+		{
+			fixed[ M.dirichlet_indices[m] ] = 1; 
+			rho[ M.dirichlet_indices[m] ] = M.dirichlet_packed_values[start+q]; 
+		}
+	}
+	
+	// residual r = b - A*rho on the free voxels. The right-hand side b includes 
+	// the coupling to the Dirichlet neighbors; its norm sets the tolerance. 
+	std::vector<double> r( number_of_voxels , 0.0 ); 
+	std::vector<double> b( number_of_voxels , 0.0 ); 
+	#pragma omp parallel for 
+	for( int k=0; k < nz ; k++ )
+	{
+		for( int j=0; j < ny ; j++ )
+		{
+			int n = (k*ny + j)*nx; 
+			for( int i=0; i < nx ; i++ , n++ )
+			{
+				if( fixed[n] )
+				{ continue; }
+				double Arho = diagonal[n] * rho[n]; 
+				double bn = source[n]; 
+				int neighbors[6] = { i > 0 ? n-1 : -1 , i < nx-1 ? n+1 : -1 , j > 0 ? n-nx : -1 , 
+					j < ny-1 ? n+nx : -1 , k > 0 ? n-nx*ny : -1 , k < nz-1 ? n+nx*ny : -1 }; 
+				double c[6] = { cx , cx , cy , cy , cz , cz }; 
+				for( int m=0; m < 6 ; m++ )
+				{
+					if( neighbors[m] < 0 )
+					{ continue; }
+					if( fixed[ neighbors[m] ] )
+					{ bn += c[m] * rho[ neighbors[m] ]; }
+					else
+					{ Arho -= c[m] * rho[ neighbors[m] ]; }
+				}
+				b[n] = bn; 
+				r[n] = bn - Arho; 
+			}
+		}
+	}
+	
+	double b_norm = sqrt( quasi_steady_state_dot( b , b ) ); 
+	double tolerance = M.quasi_steady_state_tolerance * b_norm; 
+	if( b_norm == 0.0 )
+	{ tolerance = 1e-300; }
+	
+	// preconditioned conjugate gradients 
+	std::vector<double> z( number_of_voxels , 0.0 ); 
+	std::vector<double> p( number_of_voxels , 0.0 ); 
+	std::vector<double> Ap( number_of_voxels , 0.0 ); 
+	#pragma omp parallel for 
+	for( int n=0; n < number_of_voxels ; n++ )
+	{ z[n] = r[n] / diagonal[n]; p[n] = z[n]; }
+	double rz = quasi_steady_state_dot( r , z ); 
+	double r_norm = sqrt( quasi_steady_state_dot( r , r ) ); 
+	
+	int iteration = 0; 
+	while( r_norm > tolerance && iteration < M.quasi_steady_state_max_iterations )
+	{
+		quasi_steady_state_operator( p , Ap , diagonal , fixed , nx , ny , nz , cx , cy , cz ); 
+		double pAp = quasi_steady_state_dot( p , Ap ); 
+		if( pAp <= 0.0 )
+		{ break; } // singular (no decay, uptake, or Dirichlet nodes) 
+		double alpha = rz / pAp; 
+		
+		#pragma omp parallel for 
+		for( int n=0; n < number_of_voxels ; n++ )
+		{
+			rho[n] += alpha * p[n]; 
+			r[n] -= alpha * Ap[n]; 
+			z[n] = r[n] / diagonal[n]; 
+		}
+		
+		double rz_new = quasi_steady_state_dot( r , z ); 
+		double beta = rz_new / rz; 
+		rz = rz_new; 
+		#pragma omp parallel for 
+		for( int n=0; n < number_of_voxels ; n++ )
+		{ p[n] = z[n] + beta * p[n]; }
+		
+		r_norm = sqrt( quasi_steady_state_dot( r , r ) ); 
+		iteration++; 
+	}
+	
+	if( r_norm > tolerance )
+	{
+		std::cout << "Warning: quasi-steady-state solve for " << M.density_names[q] << " stopped after " 
+			<< iteration << " iterations with relative residual " << r_norm / ( b_norm + 1e-300 ) << std::endl; 
+	}
+	
+	#pragma omp parallel for 
+	for( int n=0; n < number_of_voxels ; n++ )
+	{ (*M.p_density_vectors)[n][q] = rho[n]; }
+	
+	return iteration; 
+}
+
 };
@@ -60,6 +60,9 @@ void diffusion_decay_solver__constant_coefficients_LOD_3D( Microenvironment& M,
 void diffusion_decay_solver__constant_coefficients_LOD_2D( Microenvironment& M, double dt ); // done
 void diffusion_decay_solver__constant_coefficients_LOD_1D( Microenvironment& M, double dt ); // done
 
+// /*! Thomas sweeps of the 2D/3D LOD solvers on the contiguous density storage (used when it is enabled) */ 
+void thomas_sweeps_on_contiguous_storage( Microenvironment& M , int dimensions ); 
+
 /*! This solves for constant diffusion coefficients on a general mesh using the 
     explicit stepping for the diffusion operator, and implicit stepping for all 
     other terms to increase stability. It is suitable for a general mesh. */ 
@@ -69,6 +72,11 @@ void diffusion_decay_explicit_uniform_rates( Microenvironment& M , double dt );
 
 void diffusion_decay_solver__constant_coefficients_explicit( Microenvironment& M, double dt ); 
 void diffusion_decay_solver__constant_coefficients_explicit_uniform_mesh( Microenvironment& M, double dt ); 
+
+// /*! quasi-steady-state solve (Cartesian mesh) for one substrate: replaces its field by the steady 
+//     state of diffusion, decay, bulk and cell sources/sinks. Returns the number of PCG iterations. */ 
+int quasi_steady_state_solver( Microenvironment& M , int substrate_index ); 
+double quasi_steady_state_source_total( Microenvironment& M , int substrate_index ); 
 };
 
 #endif 
\ No newline at end of file
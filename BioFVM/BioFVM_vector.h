@@ -54,6 +54,7 @@
 #include <vector> 
 #include <cmath>
 #include <cstring>
+#include <new>
 
 namespace BioFVM{
 
@@ -144,7 +145,49 @@ void vector3_to_list( const std::vector<double>& vect , char*& buffer , char del
 
 double dot_product( const std::vector<double>& a , const std::vector<double>& b );
 std::vector<double> cross_product( const std::vector<double>& a , const std::vector<double>& b );
-    
+
+/* allocator for flat buffers that should start on a cache line (and SIMD register)
+   boundary, e.g., std::vector<double,Aligned_Allocator<double> > */
+
+static const std::size_t BioFVM_buffer_alignment = 64;
+
+template <class T>
+class Aligned_Allocator
+{
+ public:
+	typedef T value_type;
+
+	Aligned_Allocator() {}
+	template <class U> Aligned_Allocator( const Aligned_Allocator<U>& ) {}
+
+	T* allocate( std::size_t n )
+	{
+		// over-allocate, then store the original pointer just before the aligned block
+		char* raw = (char*) std::malloc( n*sizeof(T) + BioFVM_buffer_alignment + sizeof(void*) );
+		if( raw == NULL )
+		{ throw std::bad_alloc(); }
+		std::size_t address = (std::size_t) (raw + sizeof(void*));
+		address += ( BioFVM_buffer_alignment - address % BioFVM_buffer_alignment ) % BioFVM_buffer_alignment;
+		((void**) address)[-1] = raw;
+		return (T*) address;
+	}
+	void deallocate( T* p , std::size_t )
+	{
+		if( p )
+		{ std::free( ((void**) p)[-1] ); }
+	}
+	template <class U> struct rebind { typedef Aligned_Allocator<U> other; };
+};
+
+template <class T, class U>
+bool operator==( const Aligned_Allocator<T>& , const Aligned_Allocator<U>& )
+{ return true; }
+template <class T, class U>
+bool operator!=( const Aligned_Allocator<T>& , const Aligned_Allocator<U>& )
+{ return false; }
+
+typedef std::vector<double,Aligned_Allocator<double> > aligned_double_vector;
+
 };
 
 #endif
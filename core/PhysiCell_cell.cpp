@@ -87,6 +87,7 @@
 
 #include <algorithm>
 #include <iterator> 
+#include <omp.h>
 
 namespace PhysiCell{
 
@@ -253,6 +254,11 @@ Cell_State::Cell_State()
 	total_attack_time = 0.0;
 	
 	contact_with_basement_membrane = false; 
+	
+	mechanics_asleep = false; 
+	mechanics_quiet_steps = 0; 
+	mechanics_quiet_neighbors = 0; 
+	mechanics_quiet_radius = 0.0; 
 
 	return; 
 }
@@ -425,6 +431,9 @@ Cell::Cell()
 	
 	updated_current_mechanics_voxel_index = 0;
 	
+	cached_definition_type = -1; 
+	cached_definition_index = -1; 
+	
 	is_movable = true;
 	is_out_of_domain = false;
 	displacement.resize(3,0.0); // state? 
@@ -557,7 +566,18 @@ Cell* Cell::divide( )
 	// make sure ot remove adhesions 
 	remove_all_attached_cells(); 
 	remove_all_spring_attachments(); 
+	
+	Cell* child = create_cell(functions.instantiate_cell);
+	divide_into( child , true ); 
 
+	if( this->functions.cell_division_function )
+	{ this->functions.cell_division_function( this, child); }
+
+	return child;
+}
+
+bool Cell::divide_into( Cell* child , bool update_agent_grid )
+{
 	// version 1.10.3: 
 	// conserved quantitites in custom data aer divided in half
 	// so that each daughter cell gets half of the original ;
@@ -573,7 +593,6 @@ Cell* Cell::divide( )
 	}
 
 	
-	Cell* child = create_cell(functions.instantiate_cell);
 	child->copy_data( this );	
 	child->copy_function_pointers(this);
 	child->parameters = parameters;
@@ -619,9 +638,18 @@ Cell* Cell::divide( )
 		rand_vec[1]*state.orientation[1]+rand_vec[2]*state.orientation[2])*state.orientation;	
 	rand_vec *= phenotype.geometry.radius;
 
-	child->assign_position(position[0] + rand_vec[0],
-						   position[1] + rand_vec[1],
-						   position[2] + rand_vec[2]);
+	if( update_agent_grid )
+	{
+		child->assign_position(position[0] + rand_vec[0],
+							   position[1] + rand_vec[1],
+							   position[2] + rand_vec[2]);
+	}
+	else
+	{
+		child->move_to_position(position[0] + rand_vec[0],
+								position[1] + rand_vec[1],
+								position[2] + rand_vec[2]);
+	}
 						 
 	//change my position to keep the center of mass intact 
 	// and then see if I need to update my voxel index
@@ -637,7 +665,11 @@ Cell* Cell::divide( )
 		is_movable = false;
 	}	
 	 
-	update_voxel_in_container();
+	bool left_domain = false; 
+	if( update_agent_grid )
+	{ update_voxel_in_container(); }
+	else
+	{ left_domain = move_to_updated_voxel(); }
 	phenotype.volume.divide(); 
 	child->phenotype.volume.divide();
 	child->set_total_volume(child->phenotype.volume.total);
@@ -645,6 +677,12 @@ Cell* Cell::divide( )
 	
 	// child->set_phenotype( phenotype ); 
 	child->phenotype = phenotype; 
+	
+	// both daughters draw their own event times 
+	phenotype.cycle.data.event_phase_index = -1; 
+	child->phenotype.cycle.data.event_phase_index = -1; 
+	phenotype.death.event_hazards.clear(); 
+	child->phenotype.death.event_hazards.clear(); 
 
     if (child->phenotype.intracellular){
         child->phenotype.intracellular->start();
@@ -663,10 +701,7 @@ Cell* Cell::divide( )
 	// child->phenotype.integrity.damage = 0.0; // leave alone - damage is heritable 
 	child->state.total_attack_time = 0.0; 
 
-	if( this->functions.cell_division_function )
-	{ this->functions.cell_division_function( this, child); }
-
-	return child;
+	return left_domain;
 }
 
 bool Cell::assign_position(std::vector<double> new_position)
@@ -683,7 +718,7 @@ void Cell::set_previous_velocity(double xV, double yV, double zV)
 	return; 
 }
 
-bool Cell::assign_position(double x, double y, double z)
+bool Cell::move_to_position(double x, double y, double z)
 {
 	position[0]=x;
 	position[1]=y;
@@ -693,6 +728,22 @@ bool Cell::assign_position(double x, double y, double z)
 	update_voxel_index();
 	// update current_mechanics_voxel_index
 	current_mechanics_voxel_index= get_container()->underlying_mesh.nearest_voxel_index( position );
+	
+	if( !get_container()->underlying_mesh.is_position_valid(x,y,z) )
+	{	
+		is_out_of_domain = true; 
+		is_active = false; 
+		is_movable = false; 
+		
+		return false;
+	}
+	
+	return true;
+}
+
+bool Cell::assign_position(double x, double y, double z)
+{
+	bool position_is_valid = move_to_position( x, y, z ); 
 
     // Since it is most likely our first position, we update the max_cell_interactive_distance_in_voxel
 	// which was not initialized at cell creation
@@ -706,16 +757,7 @@ bool Cell::assign_position(double x, double y, double z)
 
 	get_container()->register_agent(this);
 	
-	if( !get_container()->underlying_mesh.is_position_valid(x,y,z) )
-	{	
-		is_out_of_domain = true; 
-		is_active = false; 
-		is_movable = false; 
-		
-		return false;
-	}
-	
-	return true;
+	return position_is_valid;
 }
 
 void Cell::set_total_volume(double volume)
@@ -869,6 +911,23 @@ void Cell::update_position( double dt )
 		constants_defined = true; 
 	}
 	
+	advance_position( d1 , d2 ); 
+	return; 
+}
+
+void Cell::update_position( double dt , double previous_dt )
+{
+	// Adams-Bashforth with a variable step; equal steps give the weights above 
+	if( previous_dt <= 0.0 )
+	{ previous_dt = dt; }
+	double ratio = 0.5 * dt / previous_dt; 
+	
+	advance_position( dt * (1.0 + ratio) , -dt * ratio ); 
+	return; 
+}
+
+void Cell::advance_position( double d1 , double d2 )
+{
 	// new AUgust 2017
 	if( default_microenvironment_options.simulate_2D == true )
 	{ velocity[2] = 0.0; }
@@ -936,12 +995,43 @@ void Cell::update_voxel_in_container()
 			container->remove_agent_from_voxel(this, get_current_mechanics_voxel_index());
 			container->add_agent_to_voxel(this, updated_current_mechanics_voxel_index);
 		}
+		// wake any sleeping cells around the new voxel at the next mechanics step 
+		container->disturb_mechanics_voxel( updated_current_mechanics_voxel_index ); 
 		current_mechanics_voxel_index=updated_current_mechanics_voxel_index;
 	}
 	
 	return; 
 }
 
+bool Cell::move_to_updated_voxel()
+{
+	update_voxel_index();
+	
+	if( updated_current_mechanics_voxel_index == -1 )
+	{
+		current_mechanics_voxel_index = -1;
+		is_out_of_domain = true;
+		is_active = false;
+		return true; 
+	}
+	
+	if( updated_current_mechanics_voxel_index != current_mechanics_voxel_index )
+	{ get_container()->disturb_mechanics_voxel( updated_current_mechanics_voxel_index ); }
+	current_mechanics_voxel_index = updated_current_mechanics_voxel_index;
+	return false; 
+}
+
+void Cell::reassign_mechanics_voxel()
+{
+	// cells that are not in agent_grid stay out of it 
+	if( current_mechanics_voxel_index < 0 )
+	{ return; }
+	
+	current_mechanics_voxel_index = get_container()->underlying_mesh.nearest_voxel_index( position );
+	updated_current_mechanics_voxel_index = current_mechanics_voxel_index;
+	return; 
+}
+
 void Cell::copy_data(Cell* copy_me)
 {
 	// phenotype=copyMe->phenotype; //it is taken care in set_phenotype
@@ -965,6 +1055,21 @@ void Cell::copy_function_pointers(Cell* copy_me)
 	return; 
 }
 
+int Cell::definition_index( void )
+{
+	// read-only, so safe in the parallel mechanics loops; a stale cache falls back to the lookup 
+	if( cached_definition_type == type )
+	{ return cached_definition_index; }
+	return find_cell_definition_index( type ); 
+}
+
+void Cell::update_definition_index( void )
+{
+	cached_definition_index = find_cell_definition_index( type ); 
+	cached_definition_type = type; 
+	return; 
+}
+
 void Cell::add_potentials(Cell* other_agent)
 {
 	// if( this->ID == other_agent->ID )
@@ -976,105 +1081,68 @@ void Cell::add_potentials(Cell* other_agent)
 	if( other_agent->phenotype.volume.total < 1e-15 )
 	{ std::cout << "zero size cell in mechanics!" << std::endl; return; }
 */
-	// 12 uniform neighbors at a close packing distance, after dividing out all constants
-	static double simple_pressure_scale = 0.027288820670331; // 12 * (1 - sqrt(pi/(2*sqrt(3))))^2 
-	// 9.820170012151277; // 12 * ( 1 - sqrt(2*pi/sqrt(3)))^2
-
 	double distance = 0; 
 	for( int i = 0 ; i < 3 ; i++ ) 
 	{ 
 		displacement[i] = position[i] - (*other_agent).position[i]; 
 		distance += displacement[i] * displacement[i]; 
 	}
-	// Make sure that the distance is not zero
-	
-	distance = std::max(sqrt(distance), 0.00001); 
-	
-	//Repulsive
-	double R = phenotype.geometry.radius+ (*other_agent).phenotype.geometry.radius; 
-	
-	// double RN = phenotype.geometry.nuclear_radius + (*other_agent).phenotype.geometry.nuclear_radius;	
-	double temp_r, c;
-	if( distance > R ) 
-	{
-		temp_r=0;
-	}
-	// else if( distance < RN ) 
-	// {
-		// double M = 1.0; 
-		// c = 1.0 - RN/R; 
-		// c *= c; 
-		// c -= M; 
-		// temp_r = ( c*distance/RN  + M  ); 
-	// }
-	else
-	{
-		// temp_r = 1 - distance/R;
-		temp_r = -distance; // -d
-		temp_r /= R; // -d/R
-		temp_r += 1.0; // 1-d/R
-		temp_r *= temp_r; // (1-d/R)^2 
-		
-		// add the relative pressure contribution 
-		state.simple_pressure += ( temp_r / simple_pressure_scale ); // New July 2017 
-	}
+	distance = sqrt(distance); 
 	
 	// August 2017 - back to the original if both have same coefficient 
-
-	double effective_repulsion = sqrt( phenotype.mechanics.cell_cell_repulsion_strength * other_agent->phenotype.mechanics.cell_cell_repulsion_strength ); 
-	temp_r *= effective_repulsion; 
-	
-	// temp_r *= phenotype.mechanics.cell_cell_repulsion_strength; // original 
-	//////////////////////////////////////////////////////////////////
-	
-	// Adhesive
-	//double max_interactive_distance = parameters.max_interaction_distance_factor * phenotype.geometry.radius + 
-	//	(*other_agent).parameters.max_interaction_distance_factor * (*other_agent).phenotype.geometry.radius;
-		
-	double max_interactive_distance = phenotype.mechanics.relative_maximum_adhesion_distance * phenotype.geometry.radius + 
-		(*other_agent).phenotype.mechanics.relative_maximum_adhesion_distance * (*other_agent).phenotype.geometry.radius;
-		
-	if(distance < max_interactive_distance ) 
-	{	
-		// double temp_a = 1 - distance/max_interactive_distance; 
-		double temp_a = -distance; // -d
-		temp_a /= max_interactive_distance; // -d/S
-		temp_a += 1.0; // 1 - d/S 
-		temp_a *= temp_a; // (1-d/S)^2 
-		// temp_a *= phenotype.mechanics.cell_cell_adhesion_strength; // original 
-		
-		// August 2017 - back to the original if both have same coefficient 
-		// May 2022 - back to oriinal if both affinities are 1
-		int ii = find_cell_definition_index( this->type ); 
-		int jj = find_cell_definition_index( other_agent->type ); 
-
-		double adhesion_ii = phenotype.mechanics.cell_cell_adhesion_strength * phenotype.mechanics.cell_adhesion_affinities[jj]; 
-		double adhesion_jj = other_agent->phenotype.mechanics.cell_cell_adhesion_strength * other_agent->phenotype.mechanics.cell_adhesion_affinities[ii]; 
-
-		// double effective_adhesion = sqrt( phenotype.mechanics.cell_cell_adhesion_strength * other_agent->phenotype.mechanics.cell_cell_adhesion_strength ); 
-		double effective_adhesion = sqrt( adhesion_ii*adhesion_jj ); 
-		temp_a *= effective_adhesion; 
-		
-		temp_r -= temp_a;
-
-		state.neighbors.push_back(other_agent); // move here in 1.10.2 so non-adhesive cells also added. 
-	}
-	/////////////////////////////////////////////////////////////////
-	if( fabs(temp_r) < 1e-16 )
+	// May 2022 - back to oriinal if both affinities are 1
+	int ii = definition_index(); 
+	int jj = other_agent->definition_index(); 
+	double adhesion_ii = phenotype.mechanics.cell_cell_adhesion_strength * phenotype.mechanics.cell_adhesion_affinities.read()[jj]; 
+	double adhesion_jj = other_agent->phenotype.mechanics.cell_cell_adhesion_strength * other_agent->phenotype.mechanics.cell_adhesion_affinities.read()[ii]; 
+	
+	double pressure; 
+	bool neighbors; 
+	double coefficient = standard_pair_potential( distance , 
+		phenotype.geometry.radius + (*other_agent).phenotype.geometry.radius , 
+		phenotype.mechanics.cell_cell_repulsion_strength * other_agent->phenotype.mechanics.cell_cell_repulsion_strength , 
+		phenotype.mechanics.relative_maximum_adhesion_distance * phenotype.geometry.radius + 
+		(*other_agent).phenotype.mechanics.relative_maximum_adhesion_distance * (*other_agent).phenotype.geometry.radius , 
+		adhesion_ii*adhesion_jj , pressure , neighbors ); 
+	
+	// add the relative pressure contribution 
+	state.simple_pressure += pressure; // New July 2017 
+	if( neighbors )
+	{ state.neighbors.push_back(other_agent); } // move here in 1.10.2 so non-adhesive cells also added. 
+	
+	if( coefficient == 0.0 )
 	{ return; }
-	temp_r /= distance;
-	// for( int i = 0 ; i < 3 ; i++ ) 
-	// {
-	//	velocity[i] += displacement[i] * temp_r; 
-	// }
-	axpy( &velocity , temp_r , displacement ); 
-	
-	
-	// state.neighbors.push_back(other_agent); // new 1.8.0
+	axpy( &velocity , coefficient , displacement ); 
 	
 	return;
 }
 
+bool evaluate_pair_potential( Cell* pA , Cell* pB , double& coefficient , double& pressure )
+{
+	// same arithmetic as add_potentials 
+	double distance = 0; 
+	for( int i = 0 ; i < 3 ; i++ ) 
+	{ 
+		double displacement = pA->position[i] - pB->position[i]; 
+		distance += displacement * displacement; 
+	}
+	distance = sqrt(distance); 
+	
+	int ii = pA->definition_index(); 
+	int jj = pB->definition_index(); 
+	double adhesion_ii = pA->phenotype.mechanics.cell_cell_adhesion_strength * pA->phenotype.mechanics.cell_adhesion_affinities.read()[jj]; 
+	double adhesion_jj = pB->phenotype.mechanics.cell_cell_adhesion_strength * pB->phenotype.mechanics.cell_adhesion_affinities.read()[ii]; 
+	
+	bool neighbors; 
+	coefficient = standard_pair_potential( distance , 
+		pA->phenotype.geometry.radius + pB->phenotype.geometry.radius , 
+		pA->phenotype.mechanics.cell_cell_repulsion_strength * pB->phenotype.mechanics.cell_cell_repulsion_strength , 
+		pA->phenotype.mechanics.relative_maximum_adhesion_distance * pA->phenotype.geometry.radius + 
+		pB->phenotype.mechanics.relative_maximum_adhesion_distance * pB->phenotype.geometry.radius , 
+		adhesion_ii*adhesion_jj , pressure , neighbors ); 
+	return neighbors; 
+}
+
 Cell* create_cell( Cell* (*custom_instantiate)())
 {
 	Cell* pNew; 
@@ -1140,6 +1208,8 @@ void Cell::convert_to_cell_definition( Cell_Definition& cd )
 	// use the cell defaults; 
 	type = cd.type; 
 	type_name = cd.name; 
+	update_definition_index(); 
+	state.mechanics_asleep = false; // new mechanics parameters 
 	
 	custom_data = cd.custom_data; // this is kinda risky since users may want to be updating custom_data throughout
 	parameters = cd.parameters; 
@@ -1717,6 +1787,9 @@ void build_cell_definitions_maps( void )
 //	cell_definitions_by_name.
 //	cell_definitions_by_index
 
+	// chemotaxis settings may have changed 
+	microenvironment.gradient_substrate_mask_up_to_date = false; 
+
 	for( int n=0; n < cell_definitions_by_index.size() ; n++ )
 	{
 		Cell_Definition* pCD = cell_definitions_by_index[n]; 
@@ -3363,9 +3436,33 @@ void initialize_cell_definitions_from_pugixml( void )
 int Cell_State::number_of_attached_cells( void )
 { return attached_cells.size(); } 
 
+// Each cell's attachment lists are guarded by one of a fixed set of locks (picked by cell ID), 
+// so threads only wait on each other when they change the lists of the same (or a colliding) cell 
+class Attachment_Locks
+{
+ public:
+	static const int number_of_locks = 1024; 
+	omp_lock_t locks[number_of_locks]; 
+	
+	Attachment_Locks()
+	{
+		for( int i=0; i < number_of_locks ; i++ )
+		{ omp_init_lock( locks+i ); }
+	}
+	~Attachment_Locks()
+	{
+		for( int i=0; i < number_of_locks ; i++ )
+		{ omp_destroy_lock( locks+i ); }
+	}
+	omp_lock_t* lock_for( Cell* pCell )
+	{ return locks + ( (unsigned int) pCell->ID % number_of_locks ); }
+}; 
+
+Attachment_Locks attachment_locks; 
+
 void Cell::attach_cell( Cell* pAddMe )
 {
-	#pragma omp critical
+	omp_set_lock( attachment_locks.lock_for( this ) ); 
 	{
 		bool already_attached = false; 
 		for( int i=0 ; i < state.attached_cells.size() ; i++ )
@@ -3376,13 +3473,14 @@ void Cell::attach_cell( Cell* pAddMe )
 		if( already_attached == false )
 		{ state.attached_cells.push_back( pAddMe ); }
 	}
+	omp_unset_lock( attachment_locks.lock_for( this ) ); 
 	// pAddMe->attach_cell( this ); 
 	return; 
 }
 
 void Cell::attach_cell_as_spring( Cell* pAddMe )
 {
-	#pragma omp critical
+	omp_set_lock( attachment_locks.lock_for( this ) ); 
 	{
 		bool already_attached = false; 
 		for( int i=0 ; i < state.spring_attachments.size() ; i++ )
@@ -3393,13 +3491,14 @@ void Cell::attach_cell_as_spring( Cell* pAddMe )
 		if( already_attached == false )
 		{ state.spring_attachments.push_back( pAddMe ); }
 	}
+	omp_unset_lock( attachment_locks.lock_for( this ) ); 
 	// pAddMe->attach_cell( this ); 
 	return; 
 }
 
 void Cell::detach_cell( Cell* pRemoveMe )
 {
-	#pragma omp critical
+	omp_set_lock( attachment_locks.lock_for( this ) ); 
 	{
 		bool found = false; 
 		int i = 0; 
@@ -3418,12 +3517,13 @@ void Cell::detach_cell( Cell* pRemoveMe )
 			i++; 
 		}
 	}
+	omp_unset_lock( attachment_locks.lock_for( this ) ); 
 	return; 
 }
 
 void Cell::detach_cell_as_spring( Cell* pRemoveMe )
 {
-	#pragma omp critical
+	omp_set_lock( attachment_locks.lock_for( this ) ); 
 	{
 		bool found = false; 
 		int i = 0; 
@@ -3442,6 +3542,7 @@ void Cell::detach_cell_as_spring( Cell* pRemoveMe )
 			i++; 
 		}
 	}
+	omp_unset_lock( attachment_locks.lock_for( this ) ); 
 	return; 
 }
 
@@ -68,6 +68,9 @@
 #ifndef __PhysiCell_cell_h__
 #define __PhysiCell_cell_h__
 
+#include <algorithm>
+#include <cmath>
+
 #include "./PhysiCell_custom.h" 
 
 #include "../BioFVM/BioFVM.h"
@@ -162,6 +165,12 @@ class Cell_State
 	double total_attack_time; // now in interactions
 	bool contact_with_basement_membrane; // not implemented yet 
 	
+	// mechanics sleep (see PhysiCell_settings.mechanics_sleep) 
+	bool mechanics_asleep; 
+	int mechanics_quiet_steps; 
+	int mechanics_quiet_neighbors; // number of neighbors at the last awake step 
+	double mechanics_quiet_radius; // radius at the last awake step 
+	
 	Cell_State(); 
 };
 
@@ -171,6 +180,9 @@ class Cell : public Basic_Agent
 	Cell_Container * container;
 	int current_mechanics_voxel_index;
 	int updated_current_mechanics_voxel_index; // keeps the updated voxel index for later adjusting of current voxel index
+	int cached_definition_type; // the type that cached_definition_index was looked up for 
+	int cached_definition_index; 
+	void advance_position( double d1 , double d2 ); // position += d1*velocity + d2*previous_velocity 
 		
  public:
 	std::string type_name; 
@@ -186,6 +198,8 @@ class Cell : public Basic_Agent
 	void advance_bundled_phenotype_functions( double dt_ ); 
 	
 	void add_potentials(Cell*);       // Add repulsive and adhesive forces.
+	int definition_index( void ); // find_cell_definition_index( type ), without the lookup if cached 
+	void update_definition_index( void ); 
 	void set_previous_velocity(double xV, double yV, double zV);
 	int get_current_mechanics_voxel_index();
 	void turn_off_reactions(double); 		  // Turn off all the reactions of the cell
@@ -200,6 +214,9 @@ class Cell : public Basic_Agent
 	void lyse_cell( void ); 
 
 	Cell* divide( void );
+	// divide() after the daughter is created, without the division callback; with update_agent_grid 
+	// false, agent_grid is left to the caller, and this returns true if this cell left the domain 
+	bool divide_into( Cell* child , bool update_agent_grid ); 
 	void die( void ); 
 	void step(double dt);
 	Cell();
@@ -208,6 +225,7 @@ class Cell : public Basic_Agent
 	
 	bool assign_position(std::vector<double> new_position);
 	bool assign_position(double, double, double);
+	bool move_to_position(double, double, double); // as above, but leaves agent_grid to the caller 
 	void set_total_volume(double);
 	
 	double& get_total_volume(void); // NEW
@@ -218,6 +236,7 @@ class Cell : public Basic_Agent
 	
 	// mechanics 
 	void update_position( double dt ); //
+	void update_position( double dt , double previous_dt ); // for mechanics steps of varying length 
 	std::vector<double> displacement; // this should be moved to state, or made private  
 
 	
@@ -227,6 +246,8 @@ class Cell : public Basic_Agent
 	void copy_function_pointers(Cell*);
 	
 	void update_voxel_in_container(void);
+	bool move_to_updated_voxel(void); // as above, but leaves agent_grid to the caller; true if the cell left the domain 
+	void reassign_mechanics_voxel(void); // after the container's mesh is resized; agent_grid is left to the caller 
 	void copy_data(Cell *);
 	
 	void ingest_cell( Cell* pCell_to_eat ); // for use in predation, e.g., immune cells 
@@ -260,6 +281,51 @@ class Cell : public Basic_Agent
 Cell* create_cell( Cell* (*custom_instantiate)() = NULL );  
 Cell* create_cell( Cell_Definition& cd );  
 
+// the standard cell-cell potential, shared by Cell::add_potentials and the container's pair and 
+// packed kernels. R is the sum of the radii, reach the sum of the adhesion distances, and the two 
+// products those of the cells' repulsion and (affinity-weighted) adhesion strengths. Returns the 
+// coefficient of the displacement in the velocity, and sets the pressure contribution and whether 
+// the cells are within adhesion reach. Every operation is symmetric in the two cells. 
+inline double standard_pair_potential( double distance , double R , double repulsion_product , 
+	double reach , double adhesion_product , double& pressure , bool& neighbors )
+{
+	const double simple_pressure_scale = 0.027288820670331; // 12 * (1 - sqrt(pi/(2*sqrt(3))))^2 
+	
+	// Make sure that the distance is not zero
+	distance = std::max( distance , 0.00001 ); 
+	
+	double temp_r = 0.0; 
+	pressure = 0.0; 
+	if( distance <= R )
+	{
+		temp_r = -distance; // -d
+		temp_r /= R; // -d/R
+		temp_r += 1.0; // 1-d/R
+		temp_r *= temp_r; // (1-d/R)^2 
+		pressure = temp_r / simple_pressure_scale; 
+	}
+	temp_r *= sqrt( repulsion_product ); 
+	
+	neighbors = distance < reach; 
+	if( neighbors )
+	{
+		double temp_a = -distance; // -d
+		temp_a /= reach; // -d/S
+		temp_a += 1.0; // 1 - d/S 
+		temp_a *= temp_a; // (1-d/S)^2 
+		temp_a *= sqrt( adhesion_product ); 
+		temp_r -= temp_a; 
+	}
+	
+	if( fabs(temp_r) < 1e-16 )
+	{ return 0.0; }
+	return temp_r / distance; 
+}
+
+// the terms of Cell::add_potentials for one pair, evaluated once for both cells: pA's velocity gains 
+// coefficient*(pA->position - pB->position) and pB's the opposite. Returns true if they are neighbors. 
+bool evaluate_pair_potential( Cell* pA , Cell* pB , double& coefficient , double& pressure ); 
+
 void delete_cell( int ); 
 void delete_cell( Cell* ); 
 void save_all_cells_to_matlab( std::string filename ); 
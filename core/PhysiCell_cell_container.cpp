@@ -72,6 +72,7 @@
 
 #include <algorithm>
 #include <iterator> 
+#include <omp.h>
 
 using namespace BioFVM;
 
@@ -89,6 +90,12 @@ Cell_Container::Cell_Container()
 	return; 
 }	
 	
+bool lower_cell_index( Cell* pA , Cell* pB )
+{ return pA->index < pB->index; }
+
+bool lower_cell_ID( Cell* pA , Cell* pB )
+{ return pA->ID < pB->ID; }
+
 void Cell_Container::initialize(double x_start, double x_end, double y_start, double y_end, double z_start, double z_end , double voxel_size)
 {
 	initialize(x_start, x_end, y_start, y_end, z_start, z_end , voxel_size, voxel_size, voxel_size);
@@ -105,8 +112,10 @@ void Cell_Container::initialize(double x_start, double x_end, double y_start, do
 
 	underlying_mesh.resize(x_start, x_end, y_start, y_end, z_start, z_end , dx, dy, dz);
 	agent_grid.resize(underlying_mesh.voxels.size());
+	mechanics_voxel_colors.clear(); 
 	max_cell_interactive_distance_in_voxel.resize(underlying_mesh.voxels.size(), 0.0);
 	agents_in_outer_voxels.resize(6);
+	mechanics_voxel_disturbed.assign( underlying_mesh.voxels.size() , 1 ); 
 	
 	return; 
 }
@@ -131,13 +140,57 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 
 	bool time_for_phenotype = time_since_last_phenotype > phenotype_threshold;
 	bool time_for_mechanics = time_since_last_mechanics > mechanics_threshold;
+	unsigned int step = random_stream_step++; 
 
-	#pragma omp parallel for 
-	for( int i=0; i < (*all_cells).size(); i++ )
+	// the same loops sum the source strength of quasi-steady substrates, per thread 
+	bool track_sources = microenvironment.quasi_steady_state_source_tracking_enabled(); 
+	if( track_sources )
+	{ microenvironment.reset_quasi_steady_state_sources(); }
+	
+	if( microenvironment.deterministic_cell_sources_and_sinks_enabled() )
+	{
+		// each voxel is updated by one thread, its cells in list order 
+		microenvironment.bin_agents_by_voxel( all_basic_agents ); 
+		#pragma omp parallel 
+		{
+			std::vector<double> sources; 
+			#pragma omp for 
+			for( int m=0; m < microenvironment.number_of_agent_bins() ; m++ )
+			{
+				for( int i=microenvironment.agent_bin_start[m]; i < microenvironment.agent_bin_start[m+1] ; i++ )
+				{
+					Cell* pC = (Cell*) microenvironment.agents_by_voxel[i]; 
+					if( pC->is_out_of_domain == false )
+					{ pC->phenotype.secretion.advance( pC, pC->phenotype , diffusion_dt_ ); }
+					if( track_sources )
+					{ microenvironment.add_quasi_steady_state_sources( pC , sources ); }
+				}
+			}
+			microenvironment.merge_quasi_steady_state_sources( sources ); 
+		}
+		for( int i=0; i < microenvironment.agents_without_voxel.size(); i++ )
+		{
+			Cell* pC = (Cell*) microenvironment.agents_without_voxel[i]; 
+			if( pC->is_out_of_domain == false )
+			{ pC->phenotype.secretion.advance( pC, pC->phenotype , diffusion_dt_ ); }
+		}
+	}
+	else
 	{
-		if( (*all_cells)[i]->is_out_of_domain == false )
+		#pragma omp parallel 
 		{
-			(*all_cells)[i]->phenotype.secretion.advance( (*all_cells)[i], (*all_cells)[i]->phenotype , diffusion_dt_ );
+			std::vector<double> sources; 
+			#pragma omp for 
+			for( int i=0; i < (*all_cells).size(); i++ )
+			{
+				if( (*all_cells)[i]->is_out_of_domain == false )
+				{
+					(*all_cells)[i]->phenotype.secretion.advance( (*all_cells)[i], (*all_cells)[i]->phenotype , diffusion_dt_ );
+				}
+				if( track_sources )
+				{ microenvironment.add_quasi_steady_state_sources( (*all_cells)[i] , sources ); }
+			}
+			microenvironment.merge_quasi_steady_state_sources( sources ); 
 		}
 	}
 
@@ -153,18 +206,39 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 		{
 			if( (*all_cells)[i]->is_out_of_domain == false )
 			{
+				set_random_stream( (*all_cells)[i]->ID , PhysiCell_constants::phenotype_random_stream , step ); 
 				(*all_cells)[i]->advance_bundled_phenotype_functions( time_since_last_phenotype ); 
+				clear_random_stream(); 
 			}
 		}
 		
+		// the threads flag cells in any order 
+		if( PhysiCell_settings.per_cell_random_streams )
+		{
+			std::sort( cells_ready_to_divide.begin() , cells_ready_to_divide.end() , lower_cell_ID ); 
+			std::sort( cells_ready_to_die.begin() , cells_ready_to_die.end() , lower_cell_ID ); 
+		}
+		
 		// process divides / removes 
-		for( int i=0; i < cells_ready_to_divide.size(); i++ )
+		if( PhysiCell_settings.batched_division_and_death )
 		{
-			cells_ready_to_divide[i]->divide();
+			divide_flagged_cells( step ); 
+			remove_flagged_cells(); 
+			if( cells_ready_to_divide.size() > 0 || cells_ready_to_die.size() > 0 )
+			{ fill_agent_grid(); }
 		}
-		for( int i=0; i < cells_ready_to_die.size(); i++ )
-		{	
-			cells_ready_to_die[i]->die();	
+		else
+		{
+			for( int i=0; i < cells_ready_to_divide.size(); i++ )
+			{
+				set_random_stream( cells_ready_to_divide[i]->ID , PhysiCell_constants::division_random_stream , step ); 
+				cells_ready_to_divide[i]->divide();
+				clear_random_stream(); 
+			}
+			for( int i=0; i < cells_ready_to_die.size(); i++ )
+			{	
+				cells_ready_to_die[i]->die();	
+			}
 		}
 		num_divisions_in_current_step+=  cells_ready_to_divide.size();
 		num_deaths_in_current_step+=  cells_ready_to_die.size();
@@ -178,10 +252,20 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 		
 	if( time_for_mechanics )
 	{
+		if( PhysiCell_settings.automatic_mechanics_voxel_size )
+		{ tune_mechanics_voxel_size( PhysiCell_settings.mechanics_voxel_regrid_tolerance ); }
+		if( PhysiCell_settings.mechanics_sleep )
+		{ wake_disturbed_cells( time_since_last_mechanics ); }
+		
 		// new February 2018 
 		// if we need gradients, compute them
 		if( default_microenvironment_options.calculate_gradients ) 
-		{ microenvironment.compute_all_gradient_vectors();  }
+		{
+			// only the substrates that chemotaxis or the rules read get full-mesh gradients 
+			if( microenvironment.gradient_substrate_mask_up_to_date == false )
+			{ set_gradient_substrate_mask(); }
+			microenvironment.compute_all_gradient_vectors(); 
+		}
 		// end of new in Feb 2018 
 		
 		// perform interactions -- new in June 2020 
@@ -190,7 +274,11 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 		{
 			Cell* pC = (*all_cells)[i]; 
 			if( pC->functions.contact_function && pC->is_out_of_domain == false )
-			{ evaluate_interactions( pC,pC->phenotype,time_since_last_mechanics ); }
+			{
+				set_random_stream( pC->ID , PhysiCell_constants::contact_random_stream , step ); 
+				evaluate_interactions( pC,pC->phenotype,time_since_last_mechanics ); 
+				clear_random_stream(); 
+			}
 		}
 		
 		// perform custom computations 
@@ -201,30 +289,86 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 			Cell* pC = (*all_cells)[i]; 
 						
 			if( pC->functions.custom_cell_rule && pC->is_out_of_domain == false )
-			{ pC->functions.custom_cell_rule( pC,pC->phenotype,time_since_last_mechanics ); }
+			{
+				set_random_stream( pC->ID , PhysiCell_constants::custom_rule_random_stream , step ); 
+				pC->functions.custom_cell_rule( pC,pC->phenotype,time_since_last_mechanics ); 
+				clear_random_stream(); 
+			}
 		}
 		
 		// update velocities 
 		
+		// refresh each cell's cached definition index (types may have changed since the last step) 
+		#pragma omp parallel for 
+		for( int i=0; i < (*all_cells).size(); i++ )
+		{ (*all_cells)[i]->update_definition_index(); }
+		
+		if( PhysiCell_settings.mechanics_neighbor_lists )
+		{ update_mechanics_neighbor_lists( PhysiCell_settings.mechanics_neighbor_list_skin ); }
+		if( PhysiCell_settings.mechanics_soa_kernel )
+		{ compute_snapshot_mechanics(); }
+		else if( PhysiCell_settings.mechanics_pairwise_forces )
+		{ compute_pairwise_mechanics(); }
+		
 		#pragma omp parallel for 
 		for( int i=0; i < (*all_cells).size(); i++ )
 		{
 			Cell* pC = (*all_cells)[i]; 
-			if( pC->functions.update_velocity && pC->is_out_of_domain == false && pC->is_movable )
-			{ pC->functions.update_velocity( pC,pC->phenotype,time_since_last_mechanics ); }
+			if( pC->functions.update_velocity && pC->is_out_of_domain == false && pC->is_movable && pC->state.mechanics_asleep == false )
+			{
+				set_random_stream( pC->ID , PhysiCell_constants::velocity_random_stream , step ); 
+				pC->functions.update_velocity( pC,pC->phenotype,time_since_last_mechanics ); 
+				clear_random_stream(); 
+			}
 		}
+		pairwise_mechanics_up_to_date = false; 
+		mechanics_snapshot.up_to_date = false; 
 
 		// new March 2023: 
 		// dynamic spring attachments, followed by built-in springs
 
 		if( PhysiCell_settings.disable_automated_spring_adhesions == false )
 		{
-			#pragma omp parallel for 
-			for( int i=0; i < (*all_cells).size(); i++ )
+			if( PhysiCell_settings.per_cell_random_streams )
 			{
-				Cell* pC = (*all_cells)[i]; 
-				dynamic_spring_attachments(pC,pC->phenotype,time_since_last_mechanics); 
-			}		
+				// the threads would otherwise see each other's changes in a timing-dependent order: 
+				// decide from the lists as they stand, then apply the changes in cell order 
+				int number_of_cells = (*all_cells).size(); 
+				spring_detachment_proposals.resize( number_of_cells ); 
+				spring_attachment_proposals.resize( number_of_cells ); 
+				#pragma omp parallel for 
+				for( int i=0; i < number_of_cells; i++ )
+				{
+					Cell* pC = (*all_cells)[i]; 
+					set_random_stream( pC->ID , PhysiCell_constants::attachment_random_stream , step ); 
+					propose_spring_attachment_changes( pC, pC->phenotype, time_since_last_mechanics, 
+						spring_detachment_proposals[i], spring_attachment_proposals[i] ); 
+					clear_random_stream(); 
+				}
+				for( int i=0; i < number_of_cells; i++ )
+				{
+					Cell* pC = (*all_cells)[i]; 
+					for( int j=0; j < spring_detachment_proposals[i].size(); j++ )
+					{ detach_cells_as_spring( pC , spring_detachment_proposals[i][j] ); }
+					for( int j=0; j < spring_attachment_proposals[i].size(); j++ )
+					{
+						Cell* pTest = spring_attachment_proposals[i][j]; 
+						if( pC->state.spring_attachments.size() < pC->phenotype.mechanics.maximum_number_of_attachments && 
+							pTest->state.spring_attachments.size() < pTest->phenotype.mechanics.maximum_number_of_attachments )
+						{ attach_cells_as_spring( pC , pTest ); }
+					}
+				}
+			}
+			else
+			{
+				#pragma omp parallel for 
+				for( int i=0; i < (*all_cells).size(); i++ )
+				{
+					Cell* pC = (*all_cells)[i]; 
+					dynamic_spring_attachments(pC,pC->phenotype,time_since_last_mechanics); 
+				}		
+			}
+
 			#pragma omp parallel for 
 			for( int i=0; i < (*all_cells).size(); i++ )
 			{
@@ -242,37 +386,115 @@ void Cell_Container::update_all_cells(double t, double phenotype_dt_ , double me
 
 		// new March 2022: 
 		// run standard interactions (phagocytosis, attack, fusion) here 
-		#pragma omp parallel for 
-		for( int i=0; i < (*all_cells).size(); i++ )
+		if( PhysiCell_settings.per_cell_random_streams )
 		{
-			Cell* pC = (*all_cells)[i]; 
-			standard_cell_cell_interactions(pC,pC->phenotype,time_since_last_mechanics); 
+			// as for the springs: decide in parallel from the current state, then 
+			// apply in cell ID order, skipping cells eaten or fused earlier in the pass 
+			int number_of_cells = (*all_cells).size(); 
+			cell_interaction_proposals.resize( number_of_cells ); 
+			#pragma omp parallel for 
+			for( int i=0; i < number_of_cells; i++ )
+			{
+				Cell* pC = (*all_cells)[i]; 
+				set_random_stream( pC->ID , PhysiCell_constants::cell_interaction_random_stream , step ); 
+				propose_cell_cell_interactions( pC, pC->phenotype, time_since_last_mechanics, cell_interaction_proposals[i] ); 
+				clear_random_stream(); 
+			}
+			cells_with_interactions.clear(); 
+			for( int i=0; i < number_of_cells; i++ )
+			{
+				if( cell_interaction_proposals[i].number_of_actions > 0 || cell_interaction_proposals[i].attacking )
+				{ cells_with_interactions.push_back( (*all_cells)[i] ); }
+			}
+			std::sort( cells_with_interactions.begin() , cells_with_interactions.end() , lower_cell_ID ); 
+			for( int n=0; n < cells_with_interactions.size(); n++ )
+			{
+				Cell* pC = cells_with_interactions[n]; 
+				if( pC->phenotype.volume.total >= 1e-15 )
+				{ apply_cell_cell_interactions( cell_interaction_proposals[pC->index] , time_since_last_mechanics ); }
+			}
+		}
+		else
+		{
+			#pragma omp parallel for 
+			for( int i=0; i < (*all_cells).size(); i++ )
+			{
+				Cell* pC = (*all_cells)[i]; 
+				set_random_stream( pC->ID , PhysiCell_constants::cell_interaction_random_stream , step ); 
+				standard_cell_cell_interactions(pC,pC->phenotype,time_since_last_mechanics); 
+				clear_random_stream(); 
+			}
 		}
 		// super-critical to performance! clear the "dummy" cells from phagocytosis / fusion
 		// dummy cells of size zero are left ot interact mechanically, etc. 
 		if( cells_ready_to_die.size() > 0 )
 		{
-			for( int i=0; i < cells_ready_to_die.size(); i++ )
-			{ cells_ready_to_die[i]->die(); }
+			if( PhysiCell_settings.per_cell_random_streams )
+			{ std::sort( cells_ready_to_die.begin() , cells_ready_to_die.end() , lower_cell_ID ); }
+			if( PhysiCell_settings.batched_division_and_death )
+			{
+				remove_flagged_cells(); 
+				fill_agent_grid(); 
+			}
+			else
+			{
+				for( int i=0; i < cells_ready_to_die.size(); i++ )
+				{ cells_ready_to_die[i]->die(); }
+			}
 			cells_ready_to_die.clear();
 		}
 		
 
+		if( PhysiCell_settings.mechanics_sleep )
+		{ update_mechanics_sleep( time_since_last_mechanics ); }
+		
 		// update positions 
 		
-		#pragma omp parallel for 
-		for( int i=0; i < (*all_cells).size(); i++ )
+		if( PhysiCell_settings.adaptive_mechanics_dt )
 		{
-			Cell* pC = (*all_cells)[i]; 
-			if( pC->is_out_of_domain == false && pC->is_movable)
-			{ pC->update_position(time_since_last_mechanics); }
+			// estimate the error before update_position overwrites previous_velocity 
+			double error = mechanics_step_error( time_since_last_mechanics ); 
+			#pragma omp parallel for 
+			for( int i=0; i < (*all_cells).size(); i++ )
+			{
+				Cell* pC = (*all_cells)[i]; 
+				if( pC->is_out_of_domain == false && pC->is_movable && pC->state.mechanics_asleep == false )
+				{ pC->update_position( time_since_last_mechanics , previous_mechanics_dt ); }
+			}
+			previous_mechanics_dt = time_since_last_mechanics; 
+			mechanics_threshold = next_mechanics_dt( time_since_last_mechanics , error , diffusion_dt_ , phenotype_dt_ ) - 0.5 * diffusion_dt_; 
+		}
+		else
+		{
+			#pragma omp parallel for 
+			for( int i=0; i < (*all_cells).size(); i++ )
+			{
+				Cell* pC = (*all_cells)[i]; 
+				if( pC->is_out_of_domain == false && pC->is_movable && pC->state.mechanics_asleep == false )
+				{ pC->update_position(time_since_last_mechanics); }
+			}
 		}
 		
 		// Update cell indices in the container
-		for( int i=0; i < (*all_cells).size(); i++ )
+		if( PhysiCell_settings.mechanics_rebuild_agent_grid )
+		{ rebuild_agent_grid(); }
+		else
+		{
+			for( int i=0; i < (*all_cells).size(); i++ )
+			{
+				if (!(*all_cells)[i]->is_out_of_domain && (*all_cells)[i]->is_movable)
+				{ (*all_cells)[i]->update_voxel_in_container(); }
+			}
+		}
+		
+		if( PhysiCell_settings.spatial_sort_interval > 0 )
 		{
-			if (!(*all_cells)[i]->is_out_of_domain && (*all_cells)[i]->is_movable)
-			{ (*all_cells)[i]->update_voxel_in_container(); }
+			mechanics_steps_since_spatial_sort++; 
+			if( mechanics_steps_since_spatial_sort >= PhysiCell_settings.spatial_sort_interval )
+			{
+				sort_cells_spatially(); 
+				mechanics_steps_since_spatial_sort = 0; 
+			}
 		}
 		time_since_last_mechanics = 0.0; // reset and then increment below for next cycle
 	}
@@ -328,12 +550,725 @@ void Cell_Container::update_all_cells_intracellular( void )
 void Cell_Container::register_agent( Cell* agent )
 {
 	agent_grid[agent->get_current_mechanics_voxel_index()].push_back(agent);
+	disturb_mechanics_voxel( agent->get_current_mechanics_voxel_index() ); 
+	mechanics_neighbor_lists_up_to_date = false; 
+	pairwise_mechanics_up_to_date = false; 
+	mechanics_snapshot.up_to_date = false; 
 	return; 
 }
 
 void Cell_Container::remove_agent(Cell* agent )
 {
 	remove_agent_from_voxel(agent, agent->get_current_mechanics_voxel_index());
+	disturb_mechanics_voxel( agent->get_current_mechanics_voxel_index() ); 
+	mechanics_neighbor_lists_up_to_date = false; 
+	pairwise_mechanics_up_to_date = false; 
+	mechanics_snapshot.up_to_date = false; 
+	return; 
+}
+
+// cells whose update_velocity runs this step (as in update_all_cells) and reads the 
+// container's forces (see standard_update_cell_velocity) 
+bool takes_part_in_mechanics( Cell* pC )
+{
+	return pC->functions.update_velocity == standard_update_cell_velocity && pC->is_out_of_domain == false 
+		&& pC->is_movable && pC->state.mechanics_asleep == false; 
+}
+
+// one pair, for both cells. Only the cells of the pair are written. 
+void accumulate_pair_mechanics( Cell* pA , Cell* pB , double* velocities , double* pressures )
+{
+	// this also skips pairs of sleeping cells 
+	bool a_takes_part = takes_part_in_mechanics( pA ); 
+	bool b_takes_part = takes_part_in_mechanics( pB ); 
+	if( a_takes_part == false && b_takes_part == false )
+	{ return; }
+	
+	double coefficient; 
+	double pressure; 
+	if( evaluate_pair_potential( pA , pB , coefficient , pressure ) )
+	{
+		if( a_takes_part )
+		{ pA->state.neighbors.push_back( pB ); }
+		if( b_takes_part )
+		{ pB->state.neighbors.push_back( pA ); }
+	}
+	double* pA_velocity = velocities + 3*pA->index; 
+	double* pB_velocity = velocities + 3*pB->index; 
+	for( int d=0; d < 3 ; d++ )
+	{
+		double displacement = pA->position[d] - pB->position[d]; 
+		pA_velocity[d] += coefficient * displacement; 
+		pB_velocity[d] -= coefficient * displacement; 
+	}
+	pressures[pA->index] += pressure; 
+	pressures[pB->index] += pressure; 
+	return; 
+}
+
+void Cell_Container::update_mechanics_voxel_colors( void )
+{
+	int nx = underlying_mesh.x_coordinates.size(); 
+	int ny = underlying_mesh.y_coordinates.size(); 
+	int number_of_voxels = agent_grid.size(); 
+	
+	// cleared whenever the grid is resized 
+	if( mechanics_voxel_colors.size() == 27 )
+	{ return; }
+	
+	mechanics_voxel_colors.assign( 27 , std::vector<int>() ); 
+	for( int v=0; v < number_of_voxels ; v++ )
+	{
+		int i = v % nx; 
+		int j = ( v / nx ) % ny; 
+		int k = v / ( nx*ny ); 
+		mechanics_voxel_colors[ i%3 + 3*(j%3) + 9*(k%3) ].push_back( v ); 
+	}
+	return; 
+}
+
+void Cell_Container::compute_pairwise_mechanics( void )
+{
+	int number_of_cells = (*all_cells).size(); 
+	bool use_neighbor_lists = PhysiCell_settings.mechanics_neighbor_lists && mechanics_neighbor_lists_up_to_date 
+		&& mechanics_neighbor_lists.size() == number_of_cells; 
+	
+	pairwise_velocities.assign( 3*number_of_cells , 0.0 ); 
+	pairwise_pressures.assign( number_of_cells , 0.0 ); 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		if( takes_part_in_mechanics( (*all_cells)[i] ) )
+		{ (*all_cells)[i]->state.neighbors.clear(); }
+	}
+	
+	// Verlet lists have no fixed reach in voxels: each cell sums its own list 
+	if( use_neighbor_lists )
+	{
+		#pragma omp parallel for 
+		for( int i=0; i < number_of_cells ; i++ )
+		{
+			Cell* pC = (*all_cells)[i]; 
+			if( takes_part_in_mechanics( pC ) == false )
+			{ continue; }
+			std::vector<Cell*>& candidates = mechanics_neighbor_lists[i]; 
+			for( int j=0; j < candidates.size() ; j++ )
+			{
+				double coefficient; 
+				double pressure; 
+				if( evaluate_pair_potential( pC , candidates[j] , coefficient , pressure ) )
+				{ pC->state.neighbors.push_back( candidates[j] ); }
+				for( int d=0; d < 3 ; d++ )
+				{ pairwise_velocities[3*i+d] += coefficient * ( pC->position[d] - candidates[j]->position[d] ); }
+				pairwise_pressures[i] += pressure; 
+			}
+		}
+		pairwise_mechanics_up_to_date = true; 
+		return; 
+	}
+	
+	// each pair once: each voxel with the neighboring voxels of higher index (13 of the 26 
+	// in 3-D). The colors run in order, and within a color each cell is written by one voxel 
+	// only, so every sum is accumulated in the same order for any number of threads. 
+	update_mechanics_voxel_colors(); 
+	for( int c=0; c < mechanics_voxel_colors.size() ; c++ )
+	{
+		std::vector<int>& voxels = mechanics_voxel_colors[c]; 
+		#pragma omp parallel for schedule(dynamic,16)
+		for( int m=0; m < voxels.size() ; m++ )
+		{
+			int v = voxels[m]; 
+			std::vector<Cell*>& here = agent_grid[v]; 
+			if( here.size() == 0 )
+			{ continue; }
+			for( int a=0; a < here.size() ; a++ )
+			{
+				for( int b=a+1; b < here.size() ; b++ )
+				{ accumulate_pair_mechanics( here[a] , here[b] , pairwise_velocities.data() , pairwise_pressures.data() ); }
+			}
+			std::vector<int>& neighbor_voxels = underlying_mesh.moore_connected_voxel_indices[v]; 
+			for( int n=0; n < neighbor_voxels.size() ; n++ )
+			{
+				if( neighbor_voxels[n] < v )
+				{ continue; }
+				std::vector<Cell*>& there = agent_grid[ neighbor_voxels[n] ]; 
+				for( int a=0; a < here.size() ; a++ )
+				{
+					for( int b=0; b < there.size() ; b++ )
+					{ accumulate_pair_mechanics( here[a] , there[b] , pairwise_velocities.data() , pairwise_pressures.data() ); }
+				}
+			}
+		}
+	}
+	pairwise_mechanics_up_to_date = true; 
+	return; 
+}
+
+Mechanics_Snapshot::Mechanics_Snapshot()
+{
+	number_of_cells = 0; 
+	number_of_types = 0; 
+	up_to_date = false; 
+	return; 
+}
+
+void Mechanics_Snapshot::fill( std::vector<Cell*>& cells )
+{
+	number_of_cells = cells.size(); 
+	number_of_types = cell_definitions_by_index.size(); 
+	
+	x.resize( number_of_cells ); 
+	y.resize( number_of_cells ); 
+	z.resize( number_of_cells ); 
+	radius.resize( number_of_cells ); 
+	repulsion.resize( number_of_cells ); 
+	adhesion.resize( number_of_cells ); 
+	adhesion_reach.resize( number_of_cells ); 
+	type_index.resize( number_of_cells ); 
+	affinities.assign( number_of_cells * number_of_types , 1.0 ); 
+	velocity_x.assign( number_of_cells , 0.0 ); 
+	velocity_y.assign( number_of_cells , 0.0 ); 
+	velocity_z.assign( number_of_cells , 0.0 ); 
+	pressure.assign( number_of_cells , 0.0 ); 
+	
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		Cell* pC = cells[i]; 
+		const Mechanics& mechanics = pC->phenotype.mechanics; 
+		x[i] = pC->position[0]; 
+		y[i] = pC->position[1]; 
+		z[i] = pC->position[2]; 
+		radius[i] = pC->phenotype.geometry.radius; 
+		repulsion[i] = mechanics.cell_cell_repulsion_strength; 
+		adhesion[i] = mechanics.cell_cell_adhesion_strength; 
+		adhesion_reach[i] = mechanics.relative_maximum_adhesion_distance * radius[i]; 
+		type_index[i] = pC->definition_index(); 
+		int n = std::min( (int) mechanics.cell_adhesion_affinities.size() , number_of_types ); 
+		for( int t=0; t < n ; t++ )
+		{ affinities[ i*number_of_types + t ] = mechanics.cell_adhesion_affinities[t]; }
+	}
+	up_to_date = true; 
+	return; 
+}
+
+// the forces of Cell::add_potentials on cell i from its candidates, in SIMD-friendly form. 
+// Sets is_neighbor[m] for each candidate and returns the pressure. 
+double snapshot_cell_forces( Mechanics_Snapshot& S , int i , const int* candidates , int number_of_candidates , 
+	unsigned char* is_neighbor , double* velocity )
+{
+	const double xi = S.x[i]; 
+	const double yi = S.y[i]; 
+	const double zi = S.z[i]; 
+	const double ri = S.radius[i]; 
+	const double repulsion_i = S.repulsion[i]; 
+	const double adhesion_i = S.adhesion[i]; 
+	const double reach_i = S.adhesion_reach[i]; 
+	const int T = S.number_of_types; 
+	const int type_i = S.type_index[i]; 
+	const double* affinities_i = S.affinities.data() + i*T; 
+	const double* pX = S.x.data(); 
+	const double* pY = S.y.data(); 
+	const double* pZ = S.z.data(); 
+	const double* pRadius = S.radius.data(); 
+	const double* pRepulsion = S.repulsion.data(); 
+	const double* pAdhesion = S.adhesion.data(); 
+	const double* pReach = S.adhesion_reach.data(); 
+	const int* pType = S.type_index.data(); 
+	const double* pAffinities = S.affinities.data(); 
+	
+	double vx = 0.0; 
+	double vy = 0.0; 
+	double vz = 0.0; 
+	double pressure = 0.0; 
+	#pragma omp simd reduction(+:vx,vy,vz,pressure)
+	for( int m=0; m < number_of_candidates ; m++ )
+	{
+		int j = candidates[m]; 
+		double dx = xi - pX[j]; 
+		double dy = yi - pY[j]; 
+		double dz = zi - pZ[j]; 
+		
+		double pair_pressure; 
+		bool neighbors; 
+		double coefficient = standard_pair_potential( sqrt( dx*dx + dy*dy + dz*dz ) , ri + pRadius[j] , 
+			repulsion_i * pRepulsion[j] , reach_i + pReach[j] , 
+			( adhesion_i * affinities_i[ pType[j] ] ) * ( pAdhesion[j] * pAffinities[ j*T + type_i ] ) , 
+			pair_pressure , neighbors ); 
+		pressure += pair_pressure; 
+		is_neighbor[m] = neighbors; 
+		vx += coefficient * dx; 
+		vy += coefficient * dy; 
+		vz += coefficient * dz; 
+	}
+	velocity[0] = vx; 
+	velocity[1] = vy; 
+	velocity[2] = vz; 
+	return pressure; 
+}
+
+void Cell_Container::compute_snapshot_mechanics( void )
+{
+	mechanics_snapshot.fill( *all_cells ); 
+	Mechanics_Snapshot& S = mechanics_snapshot; 
+	int number_of_cells = S.number_of_cells; 
+	bool use_neighbor_lists = PhysiCell_settings.mechanics_neighbor_lists && mechanics_neighbor_lists_up_to_date 
+		&& mechanics_neighbor_lists.size() == number_of_cells; 
+	
+	#pragma omp parallel 
+	{
+		std::vector<int> candidates; 
+		std::vector<unsigned char> is_neighbor; 
+		
+		#pragma omp for 
+		for( int i=0; i < number_of_cells ; i++ )
+		{
+			Cell* pC = (*all_cells)[i]; 
+			if( takes_part_in_mechanics( pC ) == false )
+			{ continue; }
+			
+			// candidate indices, in the order of the voxel walk of standard_update_cell_velocity 
+			candidates.clear(); 
+			if( use_neighbor_lists )
+			{
+				for( int j=0; j < mechanics_neighbor_lists[i].size() ; j++ )
+				{ candidates.push_back( mechanics_neighbor_lists[i][j]->index ); }
+			}
+			else
+			{
+				int voxel = pC->get_current_mechanics_voxel_index(); 
+				for( int v=-1; v < (int) underlying_mesh.moore_connected_voxel_indices[voxel].size() ; v++ )
+				{
+					int other_voxel = ( v < 0 ) ? voxel : underlying_mesh.moore_connected_voxel_indices[voxel][v]; 
+					if( v >= 0 && !is_neighbor_voxel( pC , underlying_mesh.voxels[voxel].center , underlying_mesh.voxels[other_voxel].center , other_voxel ) )
+					{ continue; }
+					for( int j=0; j < agent_grid[other_voxel].size() ; j++ )
+					{
+						if( agent_grid[other_voxel][j] != pC )
+						{ candidates.push_back( agent_grid[other_voxel][j]->index ); }
+					}
+				}
+			}
+			is_neighbor.resize( candidates.size() ); 
+			
+			double velocity[3]; 
+			S.pressure[i] = snapshot_cell_forces( S , i , candidates.data() , candidates.size() , is_neighbor.data() , velocity ); 
+			S.velocity_x[i] = velocity[0]; 
+			S.velocity_y[i] = velocity[1]; 
+			S.velocity_z[i] = velocity[2]; 
+			
+			pC->state.neighbors.clear(); 
+			for( int m=0; m < candidates.size() ; m++ )
+			{
+				if( is_neighbor[m] )
+				{ pC->state.neighbors.push_back( (*all_cells)[ candidates[m] ] ); }
+			}
+		}
+	}
+	return; 
+}
+
+// Morton (Z-order) key: the bits of i, j and k interleaved 
+unsigned long long morton_key( unsigned int i , unsigned int j , unsigned int k )
+{
+	unsigned long long key = 0; 
+	for( int b=0; b < 21 ; b++ )
+	{
+		key |= ( (unsigned long long) ( (i >> b) & 1 ) ) << (3*b); 
+		key |= ( (unsigned long long) ( (j >> b) & 1 ) ) << (3*b+1); 
+		key |= ( (unsigned long long) ( (k >> b) & 1 ) ) << (3*b+2); 
+	}
+	return key; 
+}
+
+void Cell_Container::sort_cells_spatially( void )
+{
+	int number_of_cells = (*all_cells).size(); 
+	int nx = underlying_mesh.x_coordinates.size(); 
+	int ny = underlying_mesh.y_coordinates.size(); 
+	
+	// cells out of the domain go last; ties keep their current order 
+	std::vector< std::pair<unsigned long long,int> > keys( number_of_cells ); 
+	#pragma omp parallel for 
+	for( int n=0; n < number_of_cells ; n++ )
+	{
+		Cell* pC = (*all_cells)[n]; 
+		int voxel = pC->get_current_mechanics_voxel_index(); 
+		unsigned long long key = ~0ULL; 
+		if( pC->is_out_of_domain == false && voxel >= 0 )
+		{ key = morton_key( voxel % nx , (voxel / nx) % ny , voxel / (nx*ny) ); }
+		keys[n] = std::make_pair( key , n ); 
+	}
+	std::sort( keys.begin() , keys.end() ); 
+	
+	std::vector<Cell*> sorted( number_of_cells ); 
+	for( int n=0; n < number_of_cells ; n++ )
+	{
+		sorted[n] = (*all_cells)[ keys[n].second ]; 
+		sorted[n]->index = n; 
+	}
+	(*all_cells).swap( sorted ); 
+	
+	#pragma omp parallel for 
+	for( int v=0; v < agent_grid.size() ; v++ )
+	{ std::sort( agent_grid[v].begin() , agent_grid[v].end() , lower_cell_index ); }
+	
+	// anything indexed by position in all_cells 
+	mechanics_neighbor_lists_up_to_date = false; 
+	pairwise_mechanics_up_to_date = false; 
+	mechanics_snapshot.up_to_date = false; 
+	return; 
+}
+
+void Cell_Container::rebuild_agent_grid( void )
+{
+	int number_of_cells = (*all_cells).size(); 
+	
+	// move the cells to the voxels found in update_position; the few that 
+	// left the domain are filed in the outer voxels serially 
+	std::vector<char>& left_domain = agent_grid_left_domain; 
+	left_domain.assign( number_of_cells , 0 ); 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		if( pC->is_out_of_domain == false && pC->is_movable )
+		{ left_domain[i] = pC->move_to_updated_voxel(); }
+	}
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		if( left_domain[i] )
+		{ add_agent_to_outer_voxel( (*all_cells)[i] ); }
+	}
+	
+	fill_agent_grid(); 
+	return; 
+}
+
+void Cell_Container::fill_agent_grid( void )
+{
+	int number_of_cells = (*all_cells).size(); 
+	int number_of_voxels = agent_grid.size(); 
+	
+	// counting sort: occupancy, offsets, scatter 
+	agent_grid_offsets.assign( number_of_voxels+1 , 0 ); 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		int voxel = (*all_cells)[i]->get_current_mechanics_voxel_index(); 
+		if( voxel >= 0 )
+		{
+			#pragma omp atomic 
+			agent_grid_offsets[voxel+1]++; 
+		}
+	}
+	for( int v=0; v < number_of_voxels ; v++ )
+	{ agent_grid_offsets[v+1] += agent_grid_offsets[v]; }
+	
+	agent_grid_cells.resize( agent_grid_offsets[number_of_voxels] ); 
+	std::vector<int>& next_slot = agent_grid_next_slot; 
+	next_slot.assign( agent_grid_offsets.begin() , agent_grid_offsets.end()-1 ); 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		int voxel = (*all_cells)[i]->get_current_mechanics_voxel_index(); 
+		if( voxel >= 0 )
+		{
+			int slot; 
+			#pragma omp atomic capture 
+			slot = next_slot[voxel]++; 
+			agent_grid_cells[slot] = (*all_cells)[i]; 
+		}
+	}
+	
+	// the scatter order depends on the threads, so put each voxel back in index order 
+	// before copying it to agent_grid (assign keeps each voxel's capacity, so this does 
+	// not allocate once the grid has settled); the interaction distances are rebuilt from scratch 
+	#pragma omp parallel for 
+	for( int v=0; v < number_of_voxels ; v++ )
+	{
+		Cell** first = agent_grid_cells.data() + agent_grid_offsets[v]; 
+		Cell** last = agent_grid_cells.data() + agent_grid_offsets[v+1]; 
+		std::sort( first , last , lower_cell_index ); 
+		agent_grid[v].assign( first , last ); 
+		
+		double max_distance = 0.0; 
+		for( Cell** pC = first; pC != last ; pC++ )
+		{
+			max_distance = std::max( max_distance , 
+				(*pC)->phenotype.geometry.radius * (*pC)->phenotype.mechanics.relative_maximum_adhesion_distance ); 
+		}
+		max_cell_interactive_distance_in_voxel[v] = max_distance; 
+	}
+	return; 
+}
+
+double Cell_Container::suggested_mechanics_voxel_size( void )
+{
+	// cells interact within the sum of their reaches, and the Moore neighborhood 
+	// search only finds pairs that are no further apart than the voxel size 
+	double max_reach = 0.0; 
+	#pragma omp parallel for reduction(max:max_reach)
+	for( int i=0; i < (*all_cells).size(); i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		if( pC->is_out_of_domain == false )
+		{ max_reach = std::max( max_reach , mechanics_interaction_reach( pC ) ); }
+	}
+	return 2.0 * max_reach; 
+}
+
+void Cell_Container::resize_mechanics_voxels( double voxel_size )
+{
+	std::vector<double> box = underlying_mesh.bounding_box; 
+	underlying_mesh.resize( box[0], box[3], box[1], box[4], box[2], box[5], voxel_size, voxel_size, voxel_size ); 
+	agent_grid.assign( underlying_mesh.voxels.size() , std::vector<Cell*>() ); 
+	mechanics_voxel_colors.clear(); 
+	max_cell_interactive_distance_in_voxel.assign( underlying_mesh.voxels.size() , 0.0 ); 
+	mechanics_voxel_disturbed.assign( underlying_mesh.voxels.size() , 1 ); 
+	
+	#pragma omp parallel for 
+	for( int i=0; i < (*all_cells).size(); i++ )
+	{ (*all_cells)[i]->reassign_mechanics_voxel(); }
+	fill_agent_grid(); 
+	
+	mechanics_neighbor_lists_up_to_date = false; 
+	pairwise_mechanics_up_to_date = false; 
+	mechanics_snapshot.up_to_date = false; 
+	return; 
+}
+
+void Cell_Container::tune_mechanics_voxel_size( double tolerance )
+{
+	double suggested = suggested_mechanics_voxel_size(); 
+	if( suggested <= 0.0 )
+	{ return; }
+	
+	// grow as soon as interactions could be missed; shrink once the voxels are 
+	// larger than needed by more than the tolerance. Leave some headroom either way. 
+	if( tolerance < 0.0 )
+	{ tolerance = 0.0; }
+	if( mechanics_voxel_size_tuned && suggested <= underlying_mesh.dx )
+	{
+		if( tolerance == 0.0 || suggested * (1.0+tolerance) >= underlying_mesh.dx )
+		{ return; }
+	}
+	
+	resize_mechanics_voxels( suggested * (1.0 + 0.5*tolerance) ); 
+	mechanics_voxel_size_tuned = true; 
+	std::cout << "Mechanics voxel size: " << underlying_mesh.dx << " (" << underlying_mesh.voxels.size() << " voxels)" << std::endl; 
+	return; 
+}
+
+double Cell_Container::mechanics_step_error( double dt )
+{
+	// Adams-Bashforth and forward Euler differ by dt^2/(2 previous_dt) * (velocity - previous_velocity), 
+	// an estimate of the local error of the step 
+	double previous_dt = ( previous_mechanics_dt > 0.0 ) ? previous_mechanics_dt : dt; 
+	int dimensions = default_microenvironment_options.simulate_2D ? 2 : 3; 
+	
+	double max_change = 0.0; 
+	#pragma omp parallel for reduction(max:max_change)
+	for( int i=0; i < (*all_cells).size(); i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		if( pC->is_out_of_domain || pC->is_movable == false || pC->state.mechanics_asleep )
+		{ continue; }
+		const std::vector<double>& previous_velocity = pC->get_previous_velocity(); 
+		double change = 0.0; 
+		for( int d=0; d < dimensions ; d++ )
+		{ change += ( pC->velocity[d] - previous_velocity[d] ) * ( pC->velocity[d] - previous_velocity[d] ); }
+		max_change = std::max( max_change , change ); 
+	}
+	return 0.5 * dt * dt / previous_dt * sqrt( max_change ); 
+}
+
+double Cell_Container::next_mechanics_dt( double dt , double error , double diffusion_dt_ , double phenotype_dt_ )
+{
+	double dt_min = std::max( PhysiCell_settings.mechanics_dt_min , diffusion_dt_ ); 
+	double dt_max = ( PhysiCell_settings.mechanics_dt_max > 0.0 ) ? PhysiCell_settings.mechanics_dt_max : phenotype_dt_; 
+	
+	// the error is second order in dt; change the step by at most a factor 5 down or 2 up 
+	double factor = 2.0; 
+	if( error > 0.0 )
+	{ factor = std::min( 2.0 , std::max( 0.2 , 0.9 * sqrt( PhysiCell_settings.mechanics_error_tolerance / error ) ) ); }
+	double next_dt = std::min( dt_max , std::max( dt_min , factor * dt ) ); 
+	
+	// mechanics runs on the diffusion steps, so keep to whole multiples of diffusion_dt 
+	int diffusion_steps = (int) floor( next_dt / diffusion_dt_ + 1e-6 ); 
+	return std::max( 1 , diffusion_steps ) * diffusion_dt_; 
+}
+
+void Cell_Container::disturb_mechanics_voxel( int voxel_index )
+{
+	if( voxel_index < 0 || voxel_index >= mechanics_voxel_disturbed.size() )
+	{ return; }
+	#pragma omp atomic write 
+	mechanics_voxel_disturbed[voxel_index] = 1; 
+	return; 
+}
+
+void Cell_Container::wake_disturbed_cells( double dt )
+{
+	double speed_threshold = PhysiCell_settings.mechanics_sleep_speed; 
+	int sleeping = 0; 
+	#pragma omp parallel for reduction(+:sleeping)
+	for( int i=0; i < (*all_cells).size(); i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		if( pC->state.mechanics_asleep == false )
+		{ continue; }
+		
+		// wake on anything that moved, appeared or disappeared in the Moore neighborhood, 
+		// or a change in the cell's own size 
+		int voxel = pC->get_current_mechanics_voxel_index(); 
+		bool wake = pC->is_out_of_domain || pC->is_movable == false || voxel < 0 
+			|| fabs( pC->phenotype.geometry.radius - pC->state.mechanics_quiet_radius ) > speed_threshold * dt; 
+		if( wake == false )
+		{
+			wake = mechanics_voxel_disturbed[voxel]; 
+			std::vector<int>& neighbor_voxels = underlying_mesh.moore_connected_voxel_indices[voxel]; 
+			for( int m=0; wake == false && m < neighbor_voxels.size() ; m++ )
+			{ wake = mechanics_voxel_disturbed[ neighbor_voxels[m] ]; }
+		}
+		
+		if( wake )
+		{
+			pC->state.mechanics_asleep = false; 
+			pC->state.mechanics_quiet_steps = 0; 
+		}
+		else
+		{ sleeping++; }
+	}
+	number_of_sleeping_cells = sleeping; 
+	
+	std::fill( mechanics_voxel_disturbed.begin() , mechanics_voxel_disturbed.end() , 0 ); 
+	return; 
+}
+
+void Cell_Container::update_mechanics_sleep( double dt )
+{
+	double speed_threshold = PhysiCell_settings.mechanics_sleep_speed; 
+	#pragma omp parallel for 
+	for( int i=0; i < (*all_cells).size(); i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		if( pC->is_out_of_domain || pC->is_movable == false )
+		{ continue; }
+		Cell_State& state = pC->state; 
+		double speed = norm( pC->velocity ); 
+		
+		if( state.mechanics_asleep )
+		{
+			// something else (e.g., a custom rule) pushed the cell 
+			if( speed >= speed_threshold )
+			{
+				state.mechanics_asleep = false; 
+				state.mechanics_quiet_steps = 0; 
+			}
+			else
+			{ pC->velocity.assign( 3 , 0.0 ); }
+			continue; 
+		}
+		
+		double radius = pC->phenotype.geometry.radius; 
+		bool quiet = speed < speed_threshold 
+			&& state.neighbors.size() == state.mechanics_quiet_neighbors 
+			&& fabs( radius - state.mechanics_quiet_radius ) <= speed_threshold * dt; 
+		state.mechanics_quiet_neighbors = state.neighbors.size(); 
+		state.mechanics_quiet_radius = radius; 
+		
+		if( quiet == false )
+		{
+			state.mechanics_quiet_steps = 0; 
+			disturb_mechanics_voxel( pC->get_current_mechanics_voxel_index() ); 
+			continue; 
+		}
+		
+		// motile cells and cells held by springs keep changing their velocity on their own 
+		state.mechanics_quiet_steps++; 
+		if( state.mechanics_quiet_steps >= PhysiCell_settings.mechanics_sleep_steps 
+			&& pC->phenotype.motility.is_motile == false && state.spring_attachments.size() == 0 )
+		{
+			state.mechanics_asleep = true; 
+			pC->velocity.assign( 3 , 0.0 ); 
+		}
+	}
+	return; 
+}
+
+// how far a cell's mechanical interactions (repulsion or adhesion) can reach 
+double mechanics_interaction_reach( Cell* pCell )
+{
+	return pCell->phenotype.geometry.radius * std::max( 1.0 , pCell->phenotype.mechanics.relative_maximum_adhesion_distance ); 
+}
+
+void Cell_Container::update_mechanics_neighbor_lists( double skin )
+{
+	int number_of_cells = (*all_cells).size(); 
+	
+	// the lists hold every pair that can interact as long as no cell has moved (or grown 
+	// its reach) by more than half the skin since they were built 
+	if( mechanics_neighbor_lists_up_to_date && mechanics_neighbor_lists.size() == number_of_cells )
+	{
+		double max_drift = 0.0; 
+		#pragma omp parallel for reduction(max:max_drift)
+		for( int i=0; i < number_of_cells ; i++ )
+		{
+			Cell* pC = (*all_cells)[i]; 
+			double* reference = mechanics_neighbor_list_positions.data() + 3*i; 
+			double drift = 0.0; 
+			for( int d=0; d < 3 ; d++ )
+			{ drift += ( pC->position[d] - reference[d] ) * ( pC->position[d] - reference[d] ); }
+			drift = sqrt( drift ) + std::max( 0.0 , mechanics_interaction_reach( pC ) - mechanics_neighbor_list_reaches[i] ); 
+			max_drift = std::max( max_drift , drift ); 
+		}
+		if( max_drift <= 0.5 * skin )
+		{ return; }
+	}
+	
+	mechanics_neighbor_lists.resize( number_of_cells ); 
+	mechanics_neighbor_list_positions.resize( 3*number_of_cells ); 
+	mechanics_neighbor_list_reaches.resize( number_of_cells ); 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		for( int d=0; d < 3 ; d++ )
+		{ mechanics_neighbor_list_positions[3*i+d] = pC->position[d]; }
+		mechanics_neighbor_list_reaches[i] = mechanics_interaction_reach( pC ); 
+	}
+	
+	// same visiting order as the voxel walk in standard_update_cell_velocity 
+	#pragma omp parallel for 
+	for( int i=0; i < number_of_cells ; i++ )
+	{
+		Cell* pC = (*all_cells)[i]; 
+		std::vector<Cell*>& candidates = mechanics_neighbor_lists[i]; 
+		candidates.clear(); 
+		if( pC->is_out_of_domain )
+		{ continue; }
+		
+		int voxel = pC->get_current_mechanics_voxel_index(); 
+		for( int v=-1; v < (int) underlying_mesh.moore_connected_voxel_indices[voxel].size() ; v++ )
+		{
+			int other_voxel = ( v < 0 ) ? voxel : underlying_mesh.moore_connected_voxel_indices[voxel][v]; 
+			for( int j=0; j < agent_grid[other_voxel].size() ; j++ )
+			{
+				Cell* pOther = agent_grid[other_voxel][j]; 
+				if( pOther == pC )
+				{ continue; }
+				double cutoff = mechanics_neighbor_list_reaches[i] + mechanics_interaction_reach( pOther ) + skin; 
+				double distance_squared = 0.0; 
+				for( int d=0; d < 3 ; d++ )
+				{ distance_squared += ( pC->position[d] - pOther->position[d] ) * ( pC->position[d] - pOther->position[d] ); }
+				if( distance_squared < cutoff*cutoff )
+				{ candidates.push_back( pOther ); }
+			}
+		}
+	}
+	mechanics_neighbor_lists_up_to_date = true; 
+	mechanics_neighbor_list_builds++; 
 	return; 
 }
 
@@ -416,6 +1351,107 @@ void Cell_Container::flag_cell_for_removal( Cell* pCell )
 	return; 
 }
 
+void Cell_Container::divide_flagged_cells( unsigned int step )
+{
+	if( cells_ready_to_divide.size() == 0 )
+	{ return; }
+	
+	// serially: release the attachments (these reach into other cells), and create the 
+	// daughters, which reserves their IDs and slots in all_cells. Intracellular models 
+	// are not cloned concurrently, so those cells divide one at a time. 
+	std::vector<Cell*> parents; 
+	std::vector<Cell*> children; 
+	parents.reserve( cells_ready_to_divide.size() ); 
+	children.reserve( cells_ready_to_divide.size() ); 
+	(*all_cells).reserve( (*all_cells).size() + cells_ready_to_divide.size() ); 
+	for( int i=0; i < cells_ready_to_divide.size(); i++ )
+	{
+		Cell* pC = cells_ready_to_divide[i]; 
+		if( pC->phenotype.intracellular )
+		{
+			set_random_stream( pC->ID , PhysiCell_constants::division_random_stream , step ); 
+			pC->divide(); 
+			clear_random_stream(); 
+			continue; 
+		}
+		pC->remove_all_attached_cells(); 
+		pC->remove_all_spring_attachments(); 
+		parents.push_back( pC ); 
+		children.push_back( create_cell( pC->functions.instantiate_cell ) ); 
+	}
+	
+	// build the daughters 
+	std::vector<char> left_domain( parents.size() , 0 ); 
+	#pragma omp parallel for 
+	for( int i=0; i < parents.size(); i++ )
+	{
+		set_random_stream( parents[i]->ID , PhysiCell_constants::division_random_stream , step ); 
+		left_domain[i] = parents[i]->divide_into( children[i] , false ); 
+		clear_random_stream(); 
+	}
+	
+	// serially: the (rare) parents pushed out of the domain, and the division functions 
+	for( int i=0; i < parents.size(); i++ )
+	{
+		if( left_domain[i] )
+		{ add_agent_to_outer_voxel( parents[i] ); }
+		disturb_mechanics_voxel( parents[i]->get_current_mechanics_voxel_index() ); 
+		disturb_mechanics_voxel( children[i]->get_current_mechanics_voxel_index() ); 
+		if( parents[i]->functions.cell_division_function )
+		{
+			set_random_stream( parents[i]->ID , PhysiCell_constants::division_function_random_stream , step ); 
+			parents[i]->functions.cell_division_function( parents[i] , children[i] ); 
+			clear_random_stream(); 
+		}
+	}
+	
+	mechanics_neighbor_lists_up_to_date = false; 
+	pairwise_mechanics_up_to_date = false; 
+	mechanics_snapshot.up_to_date = false; 
+	return; 
+}
+
+void Cell_Container::remove_flagged_cells( void )
+{
+	if( cells_ready_to_die.size() == 0 )
+	{ return; }
+	
+	// serially: what delete_cell does to the other cells and the microenvironment 
+	std::vector<char> removed( (*all_cells).size() , 0 ); 
+	for( int i=0; i < cells_ready_to_die.size(); i++ )
+	{
+		Cell* pC = cells_ready_to_die[i]; 
+		pC->remove_all_attached_cells(); 
+		pC->remove_all_spring_attachments(); 
+		pC->remove_self_from_all_neighbors(); 
+		pC->release_internalized_substrates(); 
+		disturb_mechanics_voxel( pC->get_current_mechanics_voxel_index() ); 
+		removed[ pC->index ] = 1; 
+	}
+	
+	// compact all_cells in one pass, keeping the order of the remaining cells 
+	int number_of_cells = 0; 
+	for( int i=0; i < removed.size(); i++ )
+	{
+		if( removed[i] == 0 )
+		{
+			(*all_cells)[number_of_cells] = (*all_cells)[i]; 
+			(*all_cells)[number_of_cells]->index = number_of_cells; 
+			number_of_cells++; 
+		}
+	}
+	(*all_cells).resize( number_of_cells ); 
+	
+	#pragma omp parallel for 
+	for( int i=0; i < cells_ready_to_die.size(); i++ )
+	{ delete cells_ready_to_die[i]; }
+	
+	mechanics_neighbor_lists_up_to_date = false; 
+	pairwise_mechanics_up_to_date = false; 
+	mechanics_snapshot.up_to_date = false; 
+	return; 
+}
+
 Cell_Container* create_cell_container_for_microenvironment( BioFVM::Microenvironment& m , double mechanics_voxel_size )
 {
 	Cell_Container* cell_container = new Cell_Container;
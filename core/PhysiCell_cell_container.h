@@ -77,6 +77,31 @@
 namespace PhysiCell{
 
 class Cell; 
+class Cell_Interaction_Proposals; 
+
+// packed copies of the cell inputs to the standard cell-cell forces, filled once per 
+// mechanics step, and the per-cell results (see Cell_Container::compute_snapshot_mechanics) 
+class Mechanics_Snapshot
+{
+ public:
+	int number_of_cells; 
+	int number_of_types; 
+	
+	BioFVM::aligned_double_vector x, y, z; 
+	BioFVM::aligned_double_vector radius; 
+	BioFVM::aligned_double_vector repulsion; // cell_cell_repulsion_strength 
+	BioFVM::aligned_double_vector adhesion; // cell_cell_adhesion_strength 
+	BioFVM::aligned_double_vector adhesion_reach; // relative_maximum_adhesion_distance * radius 
+	std::vector<int> type_index; // cell definition index 
+	BioFVM::aligned_double_vector affinities; // [i*number_of_types + type index] 
+	
+	BioFVM::aligned_double_vector velocity_x, velocity_y, velocity_z; 
+	BioFVM::aligned_double_vector pressure; 
+	bool up_to_date; 
+	
+	Mechanics_Snapshot(); 
+	void fill( std::vector<Cell*>& cells ); 
+}; 
 
 class Cell_Container : public BioFVM::Agent_Container
 {
@@ -100,6 +125,69 @@ class Cell_Container : public BioFVM::Agent_Container
 	std::vector<std::vector<Cell*> > agent_grid;
 	std::vector<std::vector<Cell*> > agents_in_outer_voxels;
 	
+	// Verlet lists for mechanics: the candidate neighbors of (*all_cells)[i], within the 
+	// interaction distance plus a skin. Invalidated when cells are registered or removed. 
+	std::vector<std::vector<Cell*> > mechanics_neighbor_lists; 
+	std::vector<double> mechanics_neighbor_list_positions; // 3 per cell, at the last build 
+	std::vector<double> mechanics_neighbor_list_reaches; 
+	bool mechanics_neighbor_lists_up_to_date = false; 
+	int mechanics_neighbor_list_builds = 0; 
+	void update_mechanics_neighbor_lists( double skin ); 
+	
+	// pair forces, evaluated once per pair over a half stencil and summed per cell 
+	// ahead of update_velocity (see PhysiCell_settings.mechanics_pairwise_forces) 
+	std::vector<double> pairwise_velocities; // 3 per cell 
+	std::vector<double> pairwise_pressures; 
+	bool pairwise_mechanics_up_to_date = false; 
+	void compute_pairwise_mechanics( void ); 
+	// mechanics voxels by (i%3,j%3,k%3): the half stencils of voxels of one color touch 
+	// disjoint sets of cells, so each color can run in parallel 
+	std::vector< std::vector<int> > mechanics_voxel_colors; 
+	void update_mechanics_voxel_colors( void ); 
+	
+	Mechanics_Snapshot mechanics_snapshot; 
+	void compute_snapshot_mechanics( void ); 
+	
+	// reorder all_cells (and each voxel's agents) along a Morton curve of the mechanics voxels 
+	int mechanics_steps_since_spatial_sort = 0; 
+	void sort_cells_spatially( void ); 
+	
+	// compressed copy of agent_grid: the agents of voxel v are agent_grid_cells[ agent_grid_offsets[v] ] 
+	// up to agent_grid_offsets[v+1], in index order. Valid until the next register_agent or remove_agent. 
+	std::vector<int> agent_grid_offsets; 
+	std::vector<Cell*> agent_grid_cells; 
+	// scratch for rebuild_agent_grid and fill_agent_grid, kept to reuse the allocations 
+	std::vector<char> agent_grid_left_domain; 
+	std::vector<int> agent_grid_next_slot; 
+	
+	unsigned int random_stream_step = 0; // calls to update_all_cells, for the per-cell random streams 
+	std::vector< std::vector<Cell*> > spring_detachment_proposals; // made in parallel, applied in cell order 
+	std::vector< std::vector<Cell*> > spring_attachment_proposals; 
+	std::vector<Cell_Interaction_Proposals> cell_interaction_proposals; // phagocytosis, attack, fusion 
+	std::vector<Cell*> cells_with_interactions; 
+	void rebuild_agent_grid( void ); 
+	void fill_agent_grid( void ); // from the cells' current mechanics voxels 
+	
+	// mechanics voxel size from the cells' interaction distances 
+	// (see PhysiCell_settings.automatic_mechanics_voxel_size) 
+	bool mechanics_voxel_size_tuned = false; 
+	double suggested_mechanics_voxel_size( void ); 
+	void resize_mechanics_voxels( double voxel_size ); 
+	void tune_mechanics_voxel_size( double tolerance ); 
+	
+	// adaptive mechanics steps (see PhysiCell_settings.adaptive_mechanics_dt) 
+	double previous_mechanics_dt = 0.0; 
+	double mechanics_step_error( double dt ); 
+	double next_mechanics_dt( double dt , double error , double diffusion_dt_ , double phenotype_dt_ ); 
+	
+	// mechanics sleep (see PhysiCell_settings.mechanics_sleep): voxels where a cell moved, 
+	// appeared or disappeared since the last mechanics step 
+	std::vector<char> mechanics_voxel_disturbed; 
+	int number_of_sleeping_cells = 0; 
+	void disturb_mechanics_voxel( int voxel_index ); 
+	void wake_disturbed_cells( double dt ); 
+	void update_mechanics_sleep( double dt ); 
+	
 	void update_all_cells(double t);
 	void update_all_cells(double t, double dt);
 	void update_all_cells(double t, double phenotype_dt, double mechanics_dt);
@@ -115,10 +203,16 @@ class Cell_Container : public BioFVM::Agent_Container
 	
 	void flag_cell_for_division( Cell* pCell ); 
 	void flag_cell_for_removal( Cell* pCell ); 
+	
+	// batched division and removal of the flagged cells (see PhysiCell_settings.batched_division_and_death); 
+	// both leave agent_grid to fill_agent_grid 
+	void divide_flagged_cells( unsigned int step ); 
+	void remove_flagged_cells( void ); 
 	bool contain_any_cell(int voxel_index);
 };
 
 int find_escaping_face_index(Cell* agent);
+double mechanics_interaction_reach( Cell* pCell ); // radius times max(1, relative adhesion distance)
 extern std::vector<Cell*> *all_cells; 
 
 Cell_Container* create_cell_container_for_microenvironment( BioFVM::Microenvironment& m , double mechanics_voxel_size );
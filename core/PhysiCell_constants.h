@@ -87,6 +87,16 @@ class PhysiCell_constants
 	static const int deterministic_necrosis = 0;
 	static const int stochastic_necrosis = 1;
 	
+	// call sites of the per-cell random streams (see set_random_stream) 
+	static const int phenotype_random_stream = 1; 
+	static const int division_random_stream = 2; 
+	static const int contact_random_stream = 3; 
+	static const int custom_rule_random_stream = 4; 
+	static const int velocity_random_stream = 5; 
+	static const int attachment_random_stream = 6; 
+	static const int cell_interaction_random_stream = 7; 
+	static const int division_function_random_stream = 8; 
+	
 	static const int mesh_min_x_index=0;
 	static const int mesh_min_y_index=1;
 	static const int mesh_min_z_index=2;
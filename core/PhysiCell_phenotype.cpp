@@ -71,6 +71,9 @@
 #include "./PhysiCell_constants.h"
 #include "./PhysiCell_utilities.h"
 
+#include <algorithm>
+#include <atomic>
+
 using namespace BioFVM; 
 
 namespace PhysiCell{
@@ -100,6 +103,95 @@ Phase_Link::Phase_Link()
 	return; 
 }
 
+Copy_On_Write_Vector::Copy_On_Write_Vector()
+{
+	values = std::make_shared< std::vector<double> >(); 
+	return; 
+}
+
+Copy_On_Write_Vector::Copy_On_Write_Vector( const Copy_On_Write_Vector& copy_me )
+{
+	if( PhysiCell_settings.shared_phenotype_parameters )
+	{ values = copy_me.values; }
+	else
+	{ values = std::make_shared< std::vector<double> >( *copy_me.values ); }
+	return; 
+}
+
+Copy_On_Write_Vector& Copy_On_Write_Vector::operator=( const Copy_On_Write_Vector& copy_me )
+{
+	if( values == copy_me.values )
+	{ return *this; }
+	
+	if( PhysiCell_settings.shared_phenotype_parameters )
+	{ values = copy_me.values; }
+	else if( is_unique() )
+	{ *values = *copy_me.values; } // reuse our own storage 
+	else
+	{ values = std::make_shared< std::vector<double> >( *copy_me.values ); }
+	return *this; 
+}
+
+Copy_On_Write_Vector& Copy_On_Write_Vector::operator=( const std::vector<double>& new_values )
+{
+	if( is_unique() )
+	{ *values = new_values; }
+	else
+	{ values = std::make_shared< std::vector<double> >( new_values ); }
+	return *this; 
+}
+
+Copy_On_Write_Vector& Copy_On_Write_Vector::operator=( std::initializer_list<double> new_values )
+{
+	if( is_unique() )
+	{ *values = new_values; }
+	else
+	{ values = std::make_shared< std::vector<double> >( new_values ); }
+	return *this; 
+}
+
+// use_count() is a relaxed load: the fence orders our writes after the reads that the 
+// other (former) owners made before they released the values on another thread. 
+bool Copy_On_Write_Vector::is_unique( void ) const
+{
+	if( values.use_count() != 1 )
+	{ return false; }
+	std::atomic_thread_fence( std::memory_order_acquire ); 
+	return true; 
+}
+
+// A copy that is still shared is never written in place, so other cells (on other 
+// threads) can keep reading or copying it while this one makes its own copy. 
+std::vector<double>& Copy_On_Write_Vector::writable( void )
+{
+	if( !is_unique() )
+	{ values = std::make_shared< std::vector<double> >( *values ); }
+	return *values; 
+}
+
+void Copy_On_Write_Vector::resize( int n , double value )
+{
+	writable().resize( n , value ); 
+	return; 
+}
+
+void Copy_On_Write_Vector::assign( int n , double value )
+{
+	writable().assign( n , value ); 
+	return; 
+}
+
+void Copy_On_Write_Vector::update( std::vector<double>::const_iterator first )
+{
+	if( std::equal( values->begin() , values->end() , first ) )
+	{ return; }
+	std::copy( first , first + values->size() , writable().begin() ); 
+	return; 
+}
+
+bool Copy_On_Write_Vector::is_shared( void ) const
+{ return values.use_count() > 1; }
+
 Cycle_Data::Cycle_Data()
 {
 	inverse_index_maps.resize(0); 
@@ -112,6 +204,9 @@ Cycle_Data::Cycle_Data()
 
 	current_phase_index = 0; 
 	elapsed_time_in_phase = 0.0; 
+	
+	event_phase_index = -1; 
+	event_hazards.resize( 0 ); 
 	return; 
 }
 
@@ -121,6 +216,9 @@ void Cycle_Data::sync_to_cycle_model( void )
 	int n = pCycle_Model->phases.size(); 
 	inverse_index_maps.resize( n );
 	
+	// event times belong to the previous model 
+	event_phase_index = -1; 
+	
 	// sync the inverse map to the cell cycle model by 
 	// querying the phase_links 
 
@@ -280,6 +378,21 @@ void Cycle_Model::advance_model( Cell* pCell, Phenotype& phenotype, double dt )
 	int i = phenotype.cycle.data.current_phase_index; 
 	
 	phenotype.cycle.data.elapsed_time_in_phase += dt; 
+	
+	// event-driven mode: draw the (unit-rate) hazard at which each link fires, 
+	// once per visit to the phase. Spending it at the current rates keeps this 
+	// exact when the rates change (behaviors, rules) in the meantime. 
+	bool event_driven = PhysiCell_settings.event_driven_phenotype; 
+	if( event_driven && phenotype.cycle.data.event_phase_index != i )
+	{
+		phenotype.cycle.data.event_hazards.resize( phase_links[i].size() ); 
+		for( int k=0 ; k < phase_links[i].size() ; k++ )
+		{
+			if( !phase_links[i][k].fixed_duration )
+			{ phenotype.cycle.data.event_hazards[k] = ExponentialRandom( 1.0 ); }
+		}
+		phenotype.cycle.data.event_phase_index = i; 
+	}
 
 	// Evaluate each linked phase: 
 	// advance to that phase IF probabiltiy is in the range, 
@@ -307,6 +420,14 @@ void Cycle_Model::advance_model( Cell* pCell, Phenotype& phenotype, double dt )
 					continue_transition = true; 
 				}
 			}
+			else if( event_driven )
+			{
+				phenotype.cycle.data.event_hazards[k] -= phenotype.cycle.data.transition_rates[i][k]*dt; 
+				if( phenotype.cycle.data.event_hazards[k] <= 0.0 )
+				{
+					continue_transition = true; 
+				}
+			}
 			else
 			{
 				double prob = phenotype.cycle.data.transition_rates[i][k]*dt; 
@@ -320,6 +441,9 @@ void Cycle_Model::advance_model( Cell* pCell, Phenotype& phenotype, double dt )
 			
 			if( continue_transition )
 			{
+				// leaving the phase: draw new event times on the next visit 
+				phenotype.cycle.data.event_phase_index = -1; 
+				
 				// if the phase transition has an exit function, execute it
 				if( phase_links[i][k].exit_function )
 				{
@@ -443,6 +567,31 @@ bool Death::check_for_death( double dt )
 	// If the cell is alive, evaluate all the 
 	// death rates for each registered death type. 
 	int i = 0; 
+	
+	// event-driven mode: spend a hazard drawn once per cell, instead 
+	// of drawing a random number for each rate at each step 
+	if( PhysiCell_settings.event_driven_phenotype )
+	{
+		if( event_hazards.size() != rates.size() )
+		{
+			event_hazards.resize( rates.size() ); 
+			for( int j=0 ; j < rates.size() ; j++ )
+			{ event_hazards[j] = ExponentialRandom( 1.0 ); }
+		}
+		while( !dead && i < rates.size() )
+		{
+			event_hazards[i] -= rates[i]*dt; 
+			if( event_hazards[i] <= 0.0 )
+			{
+				dead = true; 
+				current_death_model_index = i; 
+				return dead; 
+			}
+			i++; 
+		}
+		return dead; 
+	}
+	
 	while( !dead && i < rates.size() )
 	{
 		if( UniformRandom() < rates[i]*dt )
@@ -719,6 +868,13 @@ double& Mechanics::cell_adhesion_affinity( std::string type_name )
 	return cell_adhesion_affinities[n]; 
 }
 
+double Mechanics::cell_adhesion_affinity( std::string type_name ) const
+{
+	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
+	int n = cell_definition_indices_by_name[type_name]; 
+	return cell_adhesion_affinities[n]; 
+}
+
 void Mechanics::set_fully_heterotypic( void )
 {
 	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
@@ -1347,6 +1503,34 @@ double& Cell_Interactions::immunogenicity( std::string type_name )
 	return immunogenicities[n]; 
 }
 
+double Cell_Interactions::live_phagocytosis_rate( std::string type_name ) const
+{
+	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
+	int n = cell_definition_indices_by_name[type_name]; 
+	return live_phagocytosis_rates[n]; 
+}
+
+double Cell_Interactions::attack_rate( std::string type_name ) const
+{
+	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
+	int n = cell_definition_indices_by_name[type_name]; 
+	return attack_rates[n]; 
+}
+
+double Cell_Interactions::fusion_rate( std::string type_name ) const
+{
+	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
+	int n = cell_definition_indices_by_name[type_name]; 
+	return fusion_rates[n]; 
+}
+
+double Cell_Interactions::immunogenicity( std::string type_name ) const
+{
+	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
+	int n = cell_definition_indices_by_name[type_name]; 
+	return immunogenicities[n]; 
+}
+
 Cell_Transformations::Cell_Transformations()
 {
 	transformation_rates = {0.0}; 
@@ -1373,6 +1557,13 @@ double& Cell_Transformations::transformation_rate( std::string type_name )
 	return transformation_rates[n]; 
 }
 
+double Cell_Transformations::transformation_rate( std::string type_name ) const
+{
+	extern std::unordered_map<std::string,int> cell_definition_indices_by_name; 
+	int n = cell_definition_indices_by_name[type_name]; 
+	return transformation_rates[n]; 
+}
+
 Asymmetric_Division::Asymmetric_Division()
 {
 	asymmetric_division_probabilities = {0.0};
@@ -72,6 +72,8 @@
 #include <string>
 #include <unordered_map>
 #include <map> 
+#include <memory> 
+#include <initializer_list> 
 
 #include "../BioFVM/BioFVM.h" 
 
@@ -86,6 +88,61 @@ class Phenotype;
 
 class Cell_Definition; 
 
+// Per-cell-type parameters that copies of a phenotype (the cells and their Cell_Definition) share until 
+// one of them writes to them (see PhysiCell_settings.shared_phenotype_parameters). Reading through a 
+// const reference or read() never copies; every non-const access (element access, begin(), end(), data(), 
+// binding to std::vector<double>&, and the resizing functions) copies the values first if they are shared. 
+// Different cells may unshare their copies concurrently; as with std::vector, a single 
+// Copy_On_Write_Vector must not be written by two threads at once. 
+class Copy_On_Write_Vector
+{
+ private:
+	std::shared_ptr< std::vector<double> > values; 
+	bool is_unique( void ) const; 
+	std::vector<double>& writable( void ); 
+ public:
+	Copy_On_Write_Vector(); 
+	Copy_On_Write_Vector( const Copy_On_Write_Vector& copy_me ); 
+	Copy_On_Write_Vector& operator=( const Copy_On_Write_Vector& copy_me ); 
+	Copy_On_Write_Vector& operator=( const std::vector<double>& new_values ); 
+	Copy_On_Write_Vector& operator=( std::initializer_list<double> new_values ); 
+	
+	const std::vector<double>& read( void ) const { return *values; } 
+	operator const std::vector<double>&( void ) const { return *values; } 
+	operator std::vector<double>&( void ) { return writable(); } 
+	
+	std::size_t size( void ) const { return values->size(); } 
+	bool empty( void ) const { return values->empty(); } 
+	std::size_t capacity( void ) const { return values->capacity(); } 
+	
+	const double* data( void ) const { return values->data(); } 
+	double* data( void ) { return writable().data(); } 
+	const double& operator[]( int i ) const { return (*values)[i]; } 
+	double& operator[]( int i ) { return writable()[i]; } 
+	const double& at( int i ) const { return values->at(i); } 
+	double& at( int i ) { return writable().at(i); } 
+	const double& front( void ) const { return values->front(); } 
+	double& front( void ) { return writable().front(); } 
+	const double& back( void ) const { return values->back(); } 
+	double& back( void ) { return writable().back(); } 
+	
+	std::vector<double>::const_iterator begin( void ) const { return values->begin(); } 
+	std::vector<double>::const_iterator end( void ) const { return values->end(); } 
+	std::vector<double>::iterator begin( void ) { return writable().begin(); } 
+	std::vector<double>::iterator end( void ) { return writable().end(); } 
+	
+	void resize( int n , double value = 0.0 ); 
+	void assign( int n , double value ); 
+	void reserve( int n ) { writable().reserve( n ); } 
+	void push_back( double value ) { writable().push_back( value ); } 
+	void pop_back( void ) { writable().pop_back(); } 
+	void clear( void ) { writable().clear(); } 
+	// set the values from [first, first+size()), copying only if one of them changes 
+	void update( std::vector<double>::const_iterator first ); 
+	
+	bool is_shared( void ) const; 
+}; 
+
 /*
 // future use?
 class BM_Point
@@ -155,6 +212,11 @@ class Cycle_Data
 	int current_phase_index; 
 	double elapsed_time_in_phase; 
 	
+	// event-driven mode: remaining (unit-rate) hazard of each link out of 
+	// event_phase_index; re-drawn on entering a phase (-1: not drawn yet)
+	int event_phase_index; 
+	std::vector<double> event_hazards; 
+	
 	Cycle_Data(); // done 
 	
 	// return current phase (by reference)
@@ -280,6 +342,9 @@ class Death
 	bool dead; 
 	int current_death_model_index;
 	
+	// event-driven mode: remaining (unit-rate) hazard of each death model (empty: not drawn yet) 
+	std::vector<double> event_hazards; 
+	
 	Death(); // done 
 	
 	int add_death_model( double rate, Cycle_Model* pModel );  // done
@@ -385,8 +450,9 @@ class Mechanics
 	double cell_cell_repulsion_strength;
 	double cell_BM_repulsion_strength; 
 
-	std::vector<double> cell_adhesion_affinities; 
+	Copy_On_Write_Vector cell_adhesion_affinities; 
 	double& cell_adhesion_affinity( std::string type_name ); // done 
+	double cell_adhesion_affinity( std::string type_name ) const; 
 	void sync_to_cell_definitions(); // done 
 	void set_fully_heterotypic( void ); // done 
 	void set_fully_homotypic( Cell* pCell ); // done 
@@ -701,13 +767,13 @@ class Cell_Interactions
 	double necrotic_phagocytosis_rate;
 	double other_dead_phagocytosis_rate; 
 
-	std::vector<double> live_phagocytosis_rates; 
+	Copy_On_Write_Vector live_phagocytosis_rates; 
 	// attack parameters (e.g., T cells)
 
-	std::vector<double> attack_rates;
+	Copy_On_Write_Vector attack_rates;
 		// do I attack cell type j? 
 
-	std::vector<double> immunogenicities; // new! 
+	Copy_On_Write_Vector immunogenicities; // new! 
 		// how immnogenic am I to cell type j? 
 
 	double attack_damage_rate;  
@@ -718,7 +784,7 @@ class Cell_Interactions
 	double attack_duration; 
 
 	// cell fusion parameters 
-	std::vector<double> fusion_rates;
+	Copy_On_Write_Vector fusion_rates;
 	
 	// initialization 
 	Cell_Interactions(); // done 
@@ -730,6 +796,12 @@ class Cell_Interactions
 	double& fusion_rate( std::string type_name ); // done 
 	double& immunogenicity( std::string type_name ); // done 
 	
+	// as above, without copying shared rates 
+	double live_phagocytosis_rate( std::string type_name ) const; 
+	double attack_rate( std::string type_name ) const; 
+	double fusion_rate( std::string type_name ) const; 
+	double immunogenicity( std::string type_name ) const; 
+	
 	// automated cell phagocytosis, attack, and fusion 
 //	void perform_interactions( Cell* pCell, Phenotype& phenotype, double dt ); 
 };
@@ -739,7 +811,7 @@ class Cell_Transformations
  private:
  public: 
 	// rates of transforming into different cell types 
-	std::vector<double> transformation_rates; 
+	Copy_On_Write_Vector transformation_rates; 
 	
 	// initialization
 	Cell_Transformations(); // done 
@@ -747,6 +819,7 @@ class Cell_Transformations
 	
 	// ease of access 
 	double& transformation_rate( std::string type_name ); // done
+	double transformation_rate( std::string type_name ) const; 
 	
 	// automated cell transformations
 	// void perform_transformations( Cell* pCell, Phenotype& phenotype, double dt ); 
@@ -402,12 +402,14 @@ void add_behavior_ruleset( Cell_Definition* pCD )
 		// I don't think I need to sync to the cell definition
         behavior_rulesets[pCD] = std::unique_ptr<BehaviorRuleset>(new BehaviorRuleset()); // cannot use make_unique since that is only introduced in C++14
 	}
+	microenvironment.gradient_substrate_mask_up_to_date = false; 
 	return; 
 }
 
 void intialize_behavior_rulesets( void )
 {
 	behavior_rulesets.clear(); // empty(); 
+	microenvironment.gradient_substrate_mask_up_to_date = false; 
 	for (auto &pCD : cell_definitions_by_index)
 	{
 		add_behavior_ruleset(pCD); 
@@ -448,6 +450,62 @@ void setup_behavior_rules( void )
 BehaviorRuleset* find_behavior_ruleset( Cell_Definition* pCD )
 { return behavior_rulesets[pCD].get(); }
 
+void set_gradient_substrate_mask( void )
+{
+	// substrates whose gradients drive chemotaxis or appear in a rule 
+	int number_of_substrates = microenvironment.number_of_densities(); 
+	std::vector<bool> mask( number_of_substrates , false ); 
+	int first_gradient_signal = find_signal_index( microenvironment.density_names[0] + " gradient" ); 
+	int first_chemotaxis_behavior = find_behavior_index( "chemotactic response to " + microenvironment.density_names[0] ); 
+
+	for( int n=0 ; n < cell_definitions_by_index.size() ; n++ )
+	{
+		Cell_Definition* pCD = cell_definitions_by_index[n]; 
+		Motility& motility = pCD->phenotype.motility; 
+		void (*bias_function)(Cell*,Phenotype&,double) = pCD->functions.update_migration_bias; 
+
+		if( bias_function == chemotaxis_function )
+		{
+			if( motility.chemotaxis_index >= 0 && motility.chemotaxis_index < number_of_substrates )
+			{ mask[motility.chemotaxis_index] = true; }
+		}
+		else if( bias_function == advanced_chemotaxis_function || 
+			bias_function == advanced_chemotaxis_function_normalized )
+		{
+			for( int q=0; q < motility.chemotactic_sensitivities.size() && q < number_of_substrates ; q++ )
+			{
+				if( motility.chemotactic_sensitivities[q] != 0.0 )
+				{ mask[q] = true; }
+			}
+		}
+		else if( bias_function != NULL )
+		{ mask.assign( number_of_substrates , true ); } // custom migration bias: keep them all 
+
+		auto search = behavior_rulesets.find( pCD ); 
+		if( search == behavior_rulesets.end() || !search->second )
+		{ continue; }
+		std::vector<std::string> behaviors; 
+		std::vector<std::string> signals; 
+		search->second->append_behaviors_and_signals( behaviors , signals ); 
+		for( int i=0; i < behaviors.size() ; i++ )
+		{
+			int q = find_behavior_index( behaviors[i] ) - first_chemotaxis_behavior; 
+			if( first_chemotaxis_behavior >= 0 && q >= 0 && q < number_of_substrates )
+			{ mask[q] = true; }
+		}
+		for( int i=0; i < signals.size() ; i++ )
+		{
+			int q = find_signal_index( signals[i] ) - first_gradient_signal; 
+			if( first_gradient_signal >= 0 && q >= 0 && q < number_of_substrates )
+			{ mask[q] = true; }
+		}
+	}
+
+	microenvironment.gradient_substrate_mask = mask; 
+	microenvironment.gradient_substrate_mask_up_to_date = true; 
+	return; 
+}
+
 void apply_behavior_ruleset( Cell* pCell )
 {
 	Cell_Definition* pCD = find_cell_definition( pCell->type_name ); 
@@ -805,6 +863,7 @@ void parse_reference(pugi::xml_node reference_node, RelativeSignal *pRelSig)
 
 void parse_behavior_rules_from_pugixml( void )
 {
+	microenvironment.gradient_substrate_mask_up_to_date = false; 
 	pugi::xml_node node = physicell_config_root.child( "cell_rules" ); 
 	if( !node )
 	{ 
@@ -861,6 +920,7 @@ void parse_behavior_rules_from_pugixml( void )
 
 void parse_behavior_rules_from_file(std::string path_to_file, std::string format, std::string protocol, double version) // see PhysiCell_rules_extended.h for default values of format, protocol, and version
 {
+	microenvironment.gradient_substrate_mask_up_to_date = false; 
 	std::cout << "\tProcessing ruleset in " << path_to_file << " ... " << std::endl;
 
 	// get the file  extension of path_to_file
@@ -1084,6 +1144,15 @@ BehaviorRule *BehaviorRuleset::find_behavior(std::string behavior)
 	return nullptr;
 }
 
+void BehaviorRuleset::append_behaviors_and_signals(std::vector<std::string> &behaviors, std::vector<std::string> &signals)
+{
+	for (auto &rule : rules)
+	{
+		behaviors.push_back(rule->behavior);
+		rule->signal->append_signal_names(signals);
+	}
+}
+
 void set_custom_mediator(const std::string &cell_definition_name, const std::string &behavior_name, double (*mediator_function)(std::vector<double>))
 {
 	MediatorSignal *pMS = get_top_level_mediator(cell_definition_name, behavior_name);
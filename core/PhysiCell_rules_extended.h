@@ -51,6 +51,8 @@ class AbstractSignal
 public:
     virtual double evaluate(Cell *pCell) = 0;
     virtual void display(std::ostream &os, RuleLine line, int indent, std::string additional_info = "") = 0;
+    /** Appends the names of the PhysiCell signals read by this signal (and its inputs). */
+    virtual void append_signal_names(std::vector<std::string> &) {}
     virtual ~AbstractSignal() {}
 };
 
@@ -119,6 +121,14 @@ public:
 
     bool has_signals() const { return !signals.empty(); }
 
+    void append_signal_names(std::vector<std::string> &names) override
+    {
+        for (size_t i = 0; i < signals.size(); ++i)
+        {
+            signals[i]->append_signal_names(names);
+        }
+    }
+
     void display(std::ostream &os, RuleLine line, int indent, std::string additional_info = "aggregating") override;
 };
 
@@ -207,6 +217,12 @@ public:
 
     void set_mediator(std::string mediator_name);
 
+    void append_signal_names(std::vector<std::string> &names) override
+    {
+        decreasing_signal->append_signal_names(names);
+        increasing_signal->append_signal_names(names);
+    }
+
     void validate_behavior_values(double min, double base, double max)
     {
         if (min > base)
@@ -252,6 +268,8 @@ public:
 
     ElementarySignal(std::string signal_name, bool applies_to_dead) : signal_name(signal_name), applies_to_dead(applies_to_dead) {}
 
+    void append_signal_names(std::vector<std::string> &names) override { names.push_back(signal_name); }
+
     virtual void display(std::ostream &os, RuleLine line, int indent, std::string additional_info = "") override = 0;
 
     virtual ~ElementarySignal() {}
@@ -819,6 +837,9 @@ public:
 
     BehaviorRule *find_behavior(std::string behavior);
 
+    /** Appends the behaviors set by the rules and the signals they read. */
+    void append_behaviors_and_signals(std::vector<std::string> &behaviors, std::vector<std::string> &signals);
+
     void display(std::ostream &os, RuleLine line);
 
     // std::string cell_type;
@@ -879,6 +900,8 @@ void parse_reference(pugi::xml_node reference_node, RelativeSignal *pRelSig);
 
 void setup_behavior_rules( void );
 BehaviorRuleset* find_behavior_ruleset( Cell_Definition* pCD );
+// substrates whose gradients are read by chemotaxis or the rules (see Microenvironment::gradient_substrate_mask)
+void set_gradient_substrate_mask( void );
 void parse_behavior_rules_from_pugixml( void );
 void parse_behavior_rules_from_file(std::string path_to_file, std::string format = "", std::string protocol = "", double version = -1);
 
@@ -1222,7 +1222,7 @@ double get_single_signal( Cell* pCell, int index )
 	if( start_immunogenicity_ind > -1 && index >= start_immunogenicity_ind && index < max_immunogenicity_ind )
 	{
 		int j = index - start_immunogenicity_ind; 
-		out = pCell->phenotype.cell_interactions.immunogenicities[j]; 
+		out = pCell->phenotype.cell_interactions.immunogenicities.read()[j]; 
 		out /= signal_scales[index];
 		return out; 
 	}
@@ -1337,9 +1337,7 @@ void set_behaviors( Cell* pCell , std::vector<double> parameters )
 
     // cell adhesion affinities 
 	static int first_affinity_index = find_behavior_index( "adhesive affinity to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  parameters.begin()+first_affinity_index , 
-				parameters.begin()+first_affinity_index + n , 
-				pCell->phenotype.mechanics.cell_adhesion_affinities.begin() ); 	
+	pCell->phenotype.mechanics.cell_adhesion_affinities.update( parameters.begin()+first_affinity_index ); // copies shared values only if they change 	
 
 	// max relative maximum adhesion distance 
 	static int max_adhesion_distance_index = find_behavior_index("relative maximum adhesion distance"); 
@@ -1371,27 +1369,19 @@ void set_behaviors( Cell* pCell , std::vector<double> parameters )
 
     // phagocytosis of each live cell type 
 	static int first_phagocytosis_index = find_behavior_index( "phagocytose " + cell_definitions_by_type[0]->name ); 
-	std::copy(  parameters.begin()+first_phagocytosis_index , 
-				parameters.begin()+first_phagocytosis_index + n , 
-				pCell->phenotype.cell_interactions.live_phagocytosis_rates.begin() ); 	
+	pCell->phenotype.cell_interactions.live_phagocytosis_rates.update( parameters.begin()+first_phagocytosis_index ); 	
 
 	// attack of each live cell type 
 	static int first_attack_index = find_behavior_index( "attack " + cell_definitions_by_type[0]->name ); 
-	std::copy(  parameters.begin()+first_attack_index , 
-				parameters.begin()+first_attack_index + n , 
-				pCell->phenotype.cell_interactions.attack_rates.begin() ); 	
+	pCell->phenotype.cell_interactions.attack_rates.update( parameters.begin()+first_attack_index ); 	
  
 	// fusion 
 	static int first_fusion_index = find_behavior_index( "fuse to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  parameters.begin()+first_fusion_index , 
-				parameters.begin()+first_fusion_index + n , 
-				pCell->phenotype.cell_interactions.fusion_rates.begin() ); 	
+	pCell->phenotype.cell_interactions.fusion_rates.update( parameters.begin()+first_fusion_index ); 	
 
  	// transformation 
 	static int first_transformation_index = find_behavior_index( "transform to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  parameters.begin()+first_transformation_index , 
-				parameters.begin()+first_transformation_index+n , 
-				pCell->phenotype.cell_transformations.transformation_rates.begin() ); 	
+	pCell->phenotype.cell_transformations.transformation_rates.update( parameters.begin()+first_transformation_index ); 	
 
 	// asymmetric division
 	static int first_asymmetric_division_index = find_behavior_index( "asymmetric division to " + cell_definitions_by_type[0]->name );
@@ -1416,9 +1406,7 @@ void set_behaviors( Cell* pCell , std::vector<double> parameters )
 
 	// vector of immunogenicity signals 
 	static int start_immunogenicity_ind = find_behavior_index( "immunogenicity to " + cell_definitions_by_type[0]->name ); 
-    std::copy( parameters.begin()+start_immunogenicity_ind , 
-			   parameters.begin()+start_immunogenicity_ind+n , 
-			   pCell->phenotype.cell_interactions.immunogenicities.begin() );  
+    pCell->phenotype.cell_interactions.immunogenicities.update( parameters.begin()+start_immunogenicity_ind );  
 
 	// set cell attachment rate  
 	static int attachment_rate_ind = find_behavior_index( "cell attachment rate"); 
@@ -1757,8 +1745,8 @@ std::vector<double> get_behaviors( Cell* pCell )
     // cell adhesion affinities 
 	static std::string search_for1 = "adhesive affinity to " + cell_definitions_by_type[0]->name ; 
 	static int first_affinity_index = find_behavior_index( search_for1 ); 
-	std::copy(  pCell->phenotype.mechanics.cell_adhesion_affinities.begin(), 
-				pCell->phenotype.mechanics.cell_adhesion_affinities.end() ,
+	std::copy(  pCell->phenotype.mechanics.cell_adhesion_affinities.read().begin(), 
+				pCell->phenotype.mechanics.cell_adhesion_affinities.read().end() ,
 				parameters.begin()+first_affinity_index ); 
 
 	// max relative maximum adhesion distance 
@@ -1791,26 +1779,26 @@ std::vector<double> get_behaviors( Cell* pCell )
 
     // phagocytosis of each live cell type 
 	static int first_phagocytosis_index = find_behavior_index( "phagocytose " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCell->phenotype.cell_interactions.live_phagocytosis_rates.begin(), 
-				pCell->phenotype.cell_interactions.live_phagocytosis_rates.end(), 
+	std::copy(  pCell->phenotype.cell_interactions.live_phagocytosis_rates.read().begin(), 
+				pCell->phenotype.cell_interactions.live_phagocytosis_rates.read().end(), 
 				parameters.begin()+first_phagocytosis_index ); 	
 
 	// attack of each live cell type 
 	static int first_attack_index = find_behavior_index( "attack " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCell->phenotype.cell_interactions.attack_rates.begin(), 
-				pCell->phenotype.cell_interactions.attack_rates.end(), 
+	std::copy(  pCell->phenotype.cell_interactions.attack_rates.read().begin(), 
+				pCell->phenotype.cell_interactions.attack_rates.read().end(), 
 				parameters.begin()+first_attack_index ); 	
  
 	// fusion 
 	static int first_fusion_index = find_behavior_index( "fuse to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCell->phenotype.cell_interactions.fusion_rates.begin(), 
-				pCell->phenotype.cell_interactions.fusion_rates.end(), 
+	std::copy(  pCell->phenotype.cell_interactions.fusion_rates.read().begin(), 
+				pCell->phenotype.cell_interactions.fusion_rates.read().end(), 
 				parameters.begin()+first_fusion_index ); 	
 
  	// transformation 
 	static int first_transformation_index = find_behavior_index( "transform to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCell->phenotype.cell_transformations.transformation_rates.begin(), 
-				pCell->phenotype.cell_transformations.transformation_rates.end(), 
+	std::copy(  pCell->phenotype.cell_transformations.transformation_rates.read().begin(), 
+				pCell->phenotype.cell_transformations.transformation_rates.read().end(), 
 				parameters.begin()+first_transformation_index ); 	
 
 	// asymmetric division
@@ -1837,8 +1825,8 @@ std::vector<double> get_behaviors( Cell* pCell )
 
 	// vector of immunogenicity behaviors 
 	static int start_immunogenicity_ind = find_behavior_index( "immunogenicity to " + cell_definitions_by_type[0]->name ); 
-    std::copy( pCell->phenotype.cell_interactions.immunogenicities.begin(),
-			   pCell->phenotype.cell_interactions.immunogenicities.end(), 
+    std::copy( pCell->phenotype.cell_interactions.immunogenicities.read().begin(),
+			   pCell->phenotype.cell_interactions.immunogenicities.read().end(), 
 			   parameters.begin()+start_immunogenicity_ind );  
 
 	// get cell attachment rate  
@@ -1970,7 +1958,7 @@ double get_single_behavior( Cell* pCell , int index )
     // cell adhesion affinities 
 	static int first_affinity_index = find_behavior_index("adhesive affinity to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_affinity_index && index < first_affinity_index + n )
-	{ return pCell->phenotype.mechanics.cell_adhesion_affinities[index-first_affinity_index]; }
+	{ return pCell->phenotype.mechanics.cell_adhesion_affinities.read()[index-first_affinity_index]; }
 
 	// max relative maximum adhesion distance 
 	static int max_adh_index = find_behavior_index("relative maximum adhesion distance" ); 
@@ -2010,22 +1998,22 @@ double get_single_behavior( Cell* pCell , int index )
     // phagocytosis of each live cell type 
 	static int first_phagocytosis_index = find_behavior_index( "phagocytose " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_phagocytosis_index && index < first_phagocytosis_index+n )
-	{ return pCell->phenotype.cell_interactions.live_phagocytosis_rates[index-first_phagocytosis_index]; } 
+	{ return pCell->phenotype.cell_interactions.live_phagocytosis_rates.read()[index-first_phagocytosis_index]; } 
 
 	// attack of each live cell type 
 	static int first_attack_index = find_behavior_index( "attack " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_attack_index && index < first_attack_index+n )
-	{ return pCell->phenotype.cell_interactions.attack_rates[index-first_attack_index]; } 
+	{ return pCell->phenotype.cell_interactions.attack_rates.read()[index-first_attack_index]; } 
 
 	// fusion 
 	static int first_fusion_index = find_behavior_index( "fuse to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_fusion_index && index < first_fusion_index+n )
-	{ return pCell->phenotype.cell_interactions.fusion_rates[index-first_fusion_index]; } 
+	{ return pCell->phenotype.cell_interactions.fusion_rates.read()[index-first_fusion_index]; } 
 
  	// transformation 
 	static int first_transformation_index = find_behavior_index( "transform to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_transformation_index && index < first_transformation_index+n )
-	{ return pCell->phenotype.cell_transformations.transformation_rates[index-first_transformation_index]; } 
+	{ return pCell->phenotype.cell_transformations.transformation_rates.read()[index-first_transformation_index]; } 
 
 	// asymmetric division
 	static int first_asymmetric_division_index = find_behavior_index( "asymmetric division to " + cell_definitions_by_type[0]->name );
@@ -2052,7 +2040,7 @@ double get_single_behavior( Cell* pCell , int index )
 	static int start_immunogenicity_ind = find_behavior_index( "immunogenicity to " + cell_definitions_by_type[0]->name ); 
 	static int max_immunogenicity_ind = start_immunogenicity_ind + n; 
 	if( start_immunogenicity_ind > -1 && index >= start_immunogenicity_ind && index < max_immunogenicity_ind )
-	{ return pCell->phenotype.cell_interactions.immunogenicities[index-start_immunogenicity_ind]; }
+	{ return pCell->phenotype.cell_interactions.immunogenicities.read()[index-start_immunogenicity_ind]; }
 
 
 	// set cell attachment rate  
@@ -2213,8 +2201,8 @@ std::vector<double> get_base_behaviors( Cell* pCell )
     // cell adhesion affinities 
 	static std::string search_for1 = "adhesive affinity to " + cell_definitions_by_type[0]->name ; 
 	static int first_affinity_index = find_behavior_index( search_for1 ); 
-	std::copy(  pCD->phenotype.mechanics.cell_adhesion_affinities.begin(), 
-				pCD->phenotype.mechanics.cell_adhesion_affinities.end() ,
+	std::copy(  pCD->phenotype.mechanics.cell_adhesion_affinities.read().begin(), 
+				pCD->phenotype.mechanics.cell_adhesion_affinities.read().end() ,
 				parameters.begin()+first_affinity_index ); 
 
 	// max relative maximum adhesion distance 
@@ -2247,26 +2235,26 @@ std::vector<double> get_base_behaviors( Cell* pCell )
 
     // phagocytosis of each live cell type 
 	static int first_phagocytosis_index = find_behavior_index( "phagocytose " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCD->phenotype.cell_interactions.live_phagocytosis_rates.begin(), 
-				pCD->phenotype.cell_interactions.live_phagocytosis_rates.end(), 
+	std::copy(  pCD->phenotype.cell_interactions.live_phagocytosis_rates.read().begin(), 
+				pCD->phenotype.cell_interactions.live_phagocytosis_rates.read().end(), 
 				parameters.begin()+first_phagocytosis_index ); 	
 
 	// attack of each live cell type 
 	static int first_attack_index = find_behavior_index( "attack " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCD->phenotype.cell_interactions.attack_rates.begin(), 
-				pCD->phenotype.cell_interactions.attack_rates.end(), 
+	std::copy(  pCD->phenotype.cell_interactions.attack_rates.read().begin(), 
+				pCD->phenotype.cell_interactions.attack_rates.read().end(), 
 				parameters.begin()+first_attack_index ); 	
  
 	// fusion 
 	static int first_fusion_index = find_behavior_index( "fuse to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCD->phenotype.cell_interactions.fusion_rates.begin(), 
-				pCD->phenotype.cell_interactions.fusion_rates.end(), 
+	std::copy(  pCD->phenotype.cell_interactions.fusion_rates.read().begin(), 
+				pCD->phenotype.cell_interactions.fusion_rates.read().end(), 
 				parameters.begin()+first_fusion_index ); 	
 
  	// transformation 
 	static int first_transformation_index = find_behavior_index( "transform to " + cell_definitions_by_type[0]->name ); 
-	std::copy(  pCD->phenotype.cell_transformations.transformation_rates.begin(), 
-				pCD->phenotype.cell_transformations.transformation_rates.end(), 
+	std::copy(  pCD->phenotype.cell_transformations.transformation_rates.read().begin(), 
+				pCD->phenotype.cell_transformations.transformation_rates.read().end(), 
 				parameters.begin()+first_transformation_index ); 	
 
 	// asymmetric division
@@ -2293,8 +2281,8 @@ std::vector<double> get_base_behaviors( Cell* pCell )
 
 	// vector of immunogenicity behaviors 
 	static int start_immunogenicity_ind = find_behavior_index( "immunogenicity to " + cell_definitions_by_type[0]->name ); 
-    std::copy( pCD->phenotype.cell_interactions.immunogenicities.begin(),
-			   pCD->phenotype.cell_interactions.immunogenicities.end(), 
+    std::copy( pCD->phenotype.cell_interactions.immunogenicities.read().begin(),
+			   pCD->phenotype.cell_interactions.immunogenicities.read().end(), 
 			   parameters.begin()+start_immunogenicity_ind );  
 
 
@@ -2429,7 +2417,7 @@ double get_single_base_behavior( Cell* pCell , int index )
     // cell adhesion affinities 
 	static int first_affinity_index = find_behavior_index("adhesive affinity to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_affinity_index && index < first_affinity_index + n )
-	{ return pCD->phenotype.mechanics.cell_adhesion_affinities[index-first_affinity_index]; }
+	{ return pCD->phenotype.mechanics.cell_adhesion_affinities.read()[index-first_affinity_index]; }
 
 	// max relative maximum adhesion distance 
 	static int max_adh_index = find_behavior_index("relative maximum adhesion distance" ); 
@@ -2469,22 +2457,22 @@ double get_single_base_behavior( Cell* pCell , int index )
     // phagocytosis of each live cell type 
 	static int first_phagocytosis_index = find_behavior_index( "phagocytose " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_phagocytosis_index && index < first_phagocytosis_index + n )
-	{ return pCD->phenotype.cell_interactions.live_phagocytosis_rates[index-first_phagocytosis_index]; } 
+	{ return pCD->phenotype.cell_interactions.live_phagocytosis_rates.read()[index-first_phagocytosis_index]; } 
 
 	// attack of each live cell type 
 	static int first_attack_index = find_behavior_index( "attack " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_attack_index && index < first_attack_index + n )
-	{ return pCD->phenotype.cell_interactions.attack_rates[index-first_attack_index]; } 
+	{ return pCD->phenotype.cell_interactions.attack_rates.read()[index-first_attack_index]; } 
 
 	// fusion 
 	static int first_fusion_index = find_behavior_index( "fuse to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_fusion_index && index < first_fusion_index + n )
-	{ return pCD->phenotype.cell_interactions.fusion_rates[index-first_fusion_index]; } 
+	{ return pCD->phenotype.cell_interactions.fusion_rates.read()[index-first_fusion_index]; } 
 
  	// transformation 
 	static int first_transformation_index = find_behavior_index( "transform to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_transformation_index && index < first_transformation_index + n )
-	{ return pCD->phenotype.cell_transformations.transformation_rates[index-first_transformation_index]; } 
+	{ return pCD->phenotype.cell_transformations.transformation_rates.read()[index-first_transformation_index]; } 
 
 	// asymmetric division
 	static int first_asymmetric_division_index = find_behavior_index( "asymmetric division to " + cell_definitions_by_type[0]->name );
@@ -2511,7 +2499,7 @@ double get_single_base_behavior( Cell* pCell , int index )
 	static int start_immunogenicity_ind = find_behavior_index( "immunogenicity to " + cell_definitions_by_type[0]->name ); 
 	static int max_immunogenicity_ind = start_immunogenicity_ind + n; 
 	if( start_immunogenicity_ind > -1 && index >= start_immunogenicity_ind && index < max_immunogenicity_ind )
-	{ return pCD->phenotype.cell_interactions.immunogenicities[index-start_immunogenicity_ind]; }
+	{ return pCD->phenotype.cell_interactions.immunogenicities.read()[index-start_immunogenicity_ind]; }
 
 	// set cell attachment rate  
 	static int attachment_rate_ind = find_behavior_index( "cell attachment rate"); 
@@ -2651,7 +2639,7 @@ double get_single_base_behavior( Cell_Definition* pCD , int index )
     // cell adhesion affinities 
 	static int first_affinity_index = find_behavior_index("adhesive affinity to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_affinity_index && index < first_affinity_index + n )
-	{ return pCD->phenotype.mechanics.cell_adhesion_affinities[index-first_affinity_index]; }
+	{ return pCD->phenotype.mechanics.cell_adhesion_affinities.read()[index-first_affinity_index]; }
 
 	// max relative maximum adhesion distance 
 	static int max_adh_index = find_behavior_index("relative maximum adhesion distance" ); 
@@ -2691,22 +2679,22 @@ double get_single_base_behavior( Cell_Definition* pCD , int index )
     // phagocytosis of each live cell type 
 	static int first_phagocytosis_index = find_behavior_index( "phagocytose " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_phagocytosis_index && index < first_phagocytosis_index + n )
-	{ return pCD->phenotype.cell_interactions.live_phagocytosis_rates[index-first_phagocytosis_index]; } 
+	{ return pCD->phenotype.cell_interactions.live_phagocytosis_rates.read()[index-first_phagocytosis_index]; } 
 
 	// attack of each live cell type 
 	static int first_attack_index = find_behavior_index( "attack " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_attack_index && index < first_attack_index + n )
-	{ return pCD->phenotype.cell_interactions.attack_rates[index-first_attack_index]; } 
+	{ return pCD->phenotype.cell_interactions.attack_rates.read()[index-first_attack_index]; } 
 
 	// fusion 
 	static int first_fusion_index = find_behavior_index( "fuse to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_fusion_index && index < first_fusion_index + n )
-	{ return pCD->phenotype.cell_interactions.fusion_rates[index-first_fusion_index]; } 
+	{ return pCD->phenotype.cell_interactions.fusion_rates.read()[index-first_fusion_index]; } 
 
  	// transformation 
 	static int first_transformation_index = find_behavior_index( "transform to " + cell_definitions_by_type[0]->name ); 
 	if( index >= first_transformation_index && index < first_transformation_index + n )
-	{ return pCD->phenotype.cell_transformations.transformation_rates[index-first_transformation_index]; } 
+	{ return pCD->phenotype.cell_transformations.transformation_rates.read()[index-first_transformation_index]; } 
 
 	// asymmetric division
 	static int first_asymmetric_division_index = find_behavior_index( "asymmetric division to " + cell_definitions_by_type[0]->name );
@@ -2733,7 +2721,7 @@ double get_single_base_behavior( Cell_Definition* pCD , int index )
 	static int start_immunogenicity_ind = find_behavior_index( "immunogenicity to " + cell_definitions_by_type[0]->name ); 
 	static int max_immunogenicity_ind = start_immunogenicity_ind + n; 
 	if( start_immunogenicity_ind > -1 && index >= start_immunogenicity_ind && index < max_immunogenicity_ind )
-	{ return pCD->phenotype.cell_interactions.immunogenicities[index-start_immunogenicity_ind]; }
+	{ return pCD->phenotype.cell_interactions.immunogenicities.read()[index-start_immunogenicity_ind]; }
 
 	// set cell attachment rate  
 	static int attachment_rate_ind = find_behavior_index( "cell attachment rate"); 
@@ -68,6 +68,7 @@
 #include "PhysiCell_standard_models.h" 
 #include "PhysiCell_cell.h" 
 #include "../modules/PhysiCell_pathology.h"
+#include <algorithm>
 
 namespace PhysiCell{
 	
@@ -618,9 +619,52 @@ void standard_update_cell_velocity( Cell* pCell, Phenotype& phenotype, double dt
 		pCell->functions.add_cell_basement_membrane_interactions(pCell, phenotype,dt);
 	}
 	
+	// forces already evaluated on the container's packed snapshot (see Cell_Container::compute_snapshot_mechanics) 
+	Cell_Container* pContainer = pCell->get_container(); 
+	Mechanics_Snapshot& snapshot = pContainer->mechanics_snapshot; 
+	// (only cells that use this function directly are evaluated there; see takes_part_in_mechanics) 
+	bool container_forces = pCell->functions.update_velocity == standard_update_cell_velocity; 
+	if( container_forces && PhysiCell_settings.mechanics_soa_kernel && snapshot.up_to_date && pCell->index < snapshot.number_of_cells )
+	{
+		pCell->state.simple_pressure = snapshot.pressure[pCell->index]; 
+		pCell->velocity[0] += snapshot.velocity_x[pCell->index]; 
+		pCell->velocity[1] += snapshot.velocity_y[pCell->index]; 
+		pCell->velocity[2] += snapshot.velocity_z[pCell->index]; 
+		
+		pCell->update_motility_vector(dt); 
+		pCell->velocity += phenotype.motility.motility_vector; 
+		return; 
+	}
+	
+	// pair forces already summed by the container (see Cell_Container::compute_pairwise_mechanics) 
+	if( container_forces && PhysiCell_settings.mechanics_pairwise_forces && pContainer->pairwise_mechanics_up_to_date && 
+		pCell->index < pContainer->pairwise_pressures.size() )
+	{
+		pCell->state.simple_pressure = pContainer->pairwise_pressures[pCell->index]; 
+		for( int d=0; d < 3 ; d++ )
+		{ pCell->velocity[d] += pContainer->pairwise_velocities[3*pCell->index+d]; }
+		
+		pCell->update_motility_vector(dt); 
+		pCell->velocity += phenotype.motility.motility_vector; 
+		return; 
+	}
+	
 	pCell->state.simple_pressure = 0.0; 
 	pCell->state.neighbors.clear(); // new 1.8.0
 	
+	// Verlet list, if the container keeps them (see Cell_Container::update_mechanics_neighbor_lists) 
+	if( PhysiCell_settings.mechanics_neighbor_lists && pContainer->mechanics_neighbor_lists_up_to_date && 
+		pCell->index < pContainer->mechanics_neighbor_lists.size() )
+	{
+		std::vector<Cell*>& candidates = pContainer->mechanics_neighbor_lists[pCell->index]; 
+		for( int j=0; j < candidates.size() ; j++ )
+		{ pCell->add_potentials( candidates[j] ); }
+		
+		pCell->update_motility_vector(dt); 
+		pCell->velocity += phenotype.motility.motility_vector; 
+		return; 
+	}
+	
 	//First check the neighbors in my current voxel
 	std::vector<Cell*>::iterator neighbor;
 	std::vector<Cell*>::iterator end = pCell->get_container()->agent_grid[pCell->get_current_mechanics_voxel_index()].end();
@@ -991,8 +1035,8 @@ void standard_elastic_contact_function( Cell* pC1, Phenotype& p1, Cell* pC2, Phe
 	int ii = find_cell_definition_index( pC1->type ); 
 	int jj = find_cell_definition_index( pC2->type ); 
 
-	double adhesion_ii = pC1->phenotype.mechanics.attachment_elastic_constant * pC1->phenotype.mechanics.cell_adhesion_affinities[jj]; 
-	double adhesion_jj = pC2->phenotype.mechanics.attachment_elastic_constant * pC2->phenotype.mechanics.cell_adhesion_affinities[ii]; 
+	double adhesion_ii = pC1->phenotype.mechanics.attachment_elastic_constant * pC1->phenotype.mechanics.cell_adhesion_affinities.read()[jj]; 
+	double adhesion_jj = pC2->phenotype.mechanics.attachment_elastic_constant * pC2->phenotype.mechanics.cell_adhesion_affinities.read()[ii]; 
 
 	double effective_attachment_elastic_constant = sqrt( adhesion_ii*adhesion_jj ); 
 
@@ -1013,8 +1057,8 @@ void standard_elastic_contact_function_confluent_rest_length( Cell* pC1, Phenoty
 	int ii = find_cell_definition_index( pC1->type ); 
 	int jj = find_cell_definition_index( pC2->type ); 
 
-	double adhesion_ii = pC1->phenotype.mechanics.attachment_elastic_constant * pC1->phenotype.mechanics.cell_adhesion_affinities[jj]; 
-	double adhesion_jj = pC2->phenotype.mechanics.attachment_elastic_constant * pC2->phenotype.mechanics.cell_adhesion_affinities[ii]; 
+	double adhesion_ii = pC1->phenotype.mechanics.attachment_elastic_constant * pC1->phenotype.mechanics.cell_adhesion_affinities.read()[jj]; 
+	double adhesion_jj = pC2->phenotype.mechanics.attachment_elastic_constant * pC2->phenotype.mechanics.cell_adhesion_affinities.read()[ii]; 
 
 	double effective_attachment_elastic_constant = sqrt( adhesion_ii*adhesion_jj ); 
 	// axpy( &(pC1->velocity) , effective_attachment_elastic_constant , displacement ); 
@@ -1188,6 +1232,21 @@ double distance_to_domain_edge(Cell* pCell, Phenotype& phenotype, double dummy)
 
 void standard_cell_cell_interactions( Cell* pCell, Phenotype& phenotype, double dt )
 {
+	// attack_cell draws no random numbers, so deciding everything first 
+	// gives the same draws and effects as acting on each decision at once 
+	Cell_Interaction_Proposals proposals; 
+	propose_cell_cell_interactions( pCell, phenotype, dt, proposals ); 
+	apply_cell_cell_interactions( proposals , dt ); 
+	return; 
+}
+
+void propose_cell_cell_interactions( Cell* pCell, Phenotype& phenotype, double dt , Cell_Interaction_Proposals& proposals )
+{
+	proposals.pCell = pCell; 
+	proposals.number_of_actions = 0; 
+	proposals.attacking = false; 
+	proposals.attack_end_draw = 1.0; 
+	
 	if( phenotype.death.dead == true )
 	{ return; }
 	
@@ -1221,46 +1280,49 @@ void standard_cell_cell_interactions( Cell* pCell, Phenotype& phenotype, double
 			probability = phenotype.cell_interactions.apoptotic_phagocytosis_rate * dt; 
 			if( UniformRandom() < probability && phagocytosed == false && apoptotic == true ) // add the prior phago check in July 2024  
 			{
-				pCell->ingest_cell(pTarget); 
+				proposals.actions[proposals.number_of_actions] = Cell_Interaction_Proposals::phagocytosis; 
+				proposals.targets[proposals.number_of_actions++] = pTarget; 
 				phagocytosed = true; // was missing : bugfix 
-				// std::cout << "chomp apop " << PhysiCell_globals.current_time << " " << probability <<  std::endl;
 			} 
 
 			// necrotic phagocytosis 
 			probability = phenotype.cell_interactions.necrotic_phagocytosis_rate * dt; 
 			if( UniformRandom() < probability && phagocytosed == false && necrotic == true ) // add the prior phago check in July 2024  
 			{
-				pCell->ingest_cell(pTarget); 
+				proposals.actions[proposals.number_of_actions] = Cell_Interaction_Proposals::phagocytosis; 
+				proposals.targets[proposals.number_of_actions++] = pTarget; 
 				phagocytosed = true; // was missing : bugfix 
-				// std::cout << "chomp necro " << PhysiCell_globals.current_time << " " << probability <<  std::endl;
 			} 
 
 			// other dead phagocytosis 
 			probability = phenotype.cell_interactions.other_dead_phagocytosis_rate * dt; 
 			if( UniformRandom() < probability && other == true && phagocytosed == false )  
 			{
-				pCell->ingest_cell(pTarget); 
+				proposals.actions[proposals.number_of_actions] = Cell_Interaction_Proposals::phagocytosis; 
+				proposals.targets[proposals.number_of_actions++] = pTarget; 
 				phagocytosed = true; // was missing : bugfix 
-				// std::cout << "chomp other " << PhysiCell_globals.current_time << " " << probability <<  std::endl;
 			} 
 		}
 		else
 		{
+			// read the rates through const references, so that shared rates are not copied 
+			const Cell_Interactions& interactions = phenotype.cell_interactions; 
+			const Cell_Interactions& target_interactions = pTarget->phenotype.cell_interactions; 
+			
 			// live phagocytosis
 			// assume you can only phagocytose one at a time for now 
-			probability = phenotype.cell_interactions.live_phagocytosis_rate(type_name) * dt; // s[type] * dt;  
+			probability = interactions.live_phagocytosis_rate(type_name) * dt; // s[type] * dt;  
 			if( UniformRandom() < probability && phagocytosed == false ) 
 			{
-				pCell->ingest_cell(pTarget);
+				proposals.actions[proposals.number_of_actions] = Cell_Interaction_Proposals::phagocytosis; 
+				proposals.targets[proposals.number_of_actions++] = pTarget; 
 				phagocytosed = true; 
 			} 
 			
 			// attack 
 			// assume you can only attack one cell at a time 
-			// probability = phenotype.cell_interactions.attack_rate(type_name)*dt; // s[type] * dt;  
-
-			double attack_ij = phenotype.cell_interactions.attack_rate(type_name); 
-			double immunogenicity_ji = pTarget->phenotype.cell_interactions.immunogenicity(pCell->type_name); 
+			double attack_ij = interactions.attack_rate(type_name); 
+			double immunogenicity_ji = target_interactions.immunogenicity(pCell->type_name); 
 
 			// probability of STARTING an attack 
 			probability = attack_ij * immunogenicity_ji * dt; 
@@ -1268,92 +1330,68 @@ void standard_cell_cell_interactions( Cell* pCell, Phenotype& phenotype, double
 			{
 				if( UniformRandom() < probability ) 
 				{				
-					pCell->phenotype.cell_interactions.pAttackTarget = pTarget; 
+					// set the attack target and spring-link these cells 
+					proposals.actions[proposals.number_of_actions] = Cell_Interaction_Proposals::attack; 
+					proposals.targets[proposals.number_of_actions++] = pTarget; 
 					attacked = true; 
-					/*					
-					std::cout << "*********   *********  ********  start atack **** " << PhysiCell_globals.current_time << std::endl; 
-					std::cout 
-					<< "attack duration: " << pCell->phenotype.cell_interactions.attack_duration << " "  
-					<< "attack damage rate: " << pCell->phenotype.cell_interactions.attack_damage_rate <<  std::endl; 
-					*/
-					// spring-link these cells 
-					attach_cells_as_spring(pCell,pTarget); 
 				} 
 			}
-
-/*
-			// perform attack. be careful to not overcount it! 
-			// make sure that (1) I have a non-null pAttackTarget, and that (2) we are talking about pTarget 
-			// easiest way to do this is to check if the pAttackTarget = pTarget. IF pAttackTarget = NULL, it 
-			// won't be true. If pAttackTarget is non-null, but we're looking ata different cell, also not true. 
-			// if pAttackTarget = pTarget, then we're "looking" at the right cell, so do the attack. 
-			if( pCell->phenotype.cell_interactions.pAttackTarget == pTarget ) 
-			{
-				pCell->attack_cell(pCell->phenotype.cell_interactions.pAttackTarget,dt); 
-				attacked = true; // attacked at least one cell in this time step 
-
-				// probability of ending attack 
-				// end attack if target is dead 
-				probability = dt / (1e-15 + pCell->phenotype.cell_interactions.attack_duration); 
-
-				if( UniformRandom() < probability || pCell->phenotype.cell_interactions.pAttackTarget->phenotype.death.dead ) 
-				{
-					std::cout << "*********   *********  ********  attack done **** " << probability << " " << 
-					pCell->phenotype.cell_interactions.pAttackTarget->state.total_attack_time << " " 		
-					<< (int) pCell->phenotype.cell_interactions.pAttackTarget->phenotype.death.dead << std::endl; 
-					pCell->phenotype.cell_interactions.pAttackTarget = NULL; 
-				} 
-			} 
-*/
 			
 			// fusion 
 			// assume you can only fuse once cell at a time 
-			probability = phenotype.cell_interactions.fusion_rate(type_name)*dt; // s[type] * dt;  
+			probability = interactions.fusion_rate(type_name)*dt; // s[type] * dt;  
 			if( UniformRandom() < probability && fused == false  ) 
 			{
-				pCell->fuse_cell(pTarget);
+				proposals.actions[proposals.number_of_actions] = Cell_Interaction_Proposals::fusion; 
+				proposals.targets[proposals.number_of_actions++] = pTarget; 
 				fused = true; 
 			} 
 		}
 	}
+	
+	// the draw that may end the attack (see apply_cell_cell_interactions) 
+	if( pCell->phenotype.cell_interactions.pAttackTarget != NULL || attacked )
+	{
+		proposals.attacking = true; 
+		proposals.attack_end_draw = UniformRandom(); 
+	}
+	return; 
+}
 
-	// move effector attack here. 
-
-		if( pCell->phenotype.cell_interactions.pAttackTarget != NULL ) 
+void apply_cell_cell_interactions( Cell_Interaction_Proposals& proposals , double dt )
+{
+	Cell* pCell = proposals.pCell; 
+	for( int n=0; n < proposals.number_of_actions ; n++ )
+	{
+		Cell* pTarget = proposals.targets[n]; 
+		if( proposals.actions[n] == Cell_Interaction_Proposals::phagocytosis )
+		{ pCell->ingest_cell(pTarget); }
+		else if( proposals.actions[n] == Cell_Interaction_Proposals::attack )
 		{
-			Cell* pTarget = pCell->phenotype.cell_interactions.pAttackTarget; 
-
-			pCell->attack_cell(pTarget,dt); 
-			attacked = true; // attacked at least one cell in this time step 
-
-			// attack_cell
+			pCell->phenotype.cell_interactions.pAttackTarget = pTarget; 
+			attach_cells_as_spring(pCell,pTarget); 
+		}
+		else
+		{ pCell->fuse_cell(pTarget); }
+	}
 
-			// probability of ending attack 
-			// end attack if target is dead 
-			probability = dt / (1e-15 + pCell->phenotype.cell_interactions.attack_duration); 
+	// move effector attack here. 
+	if( proposals.attacking && pCell->phenotype.cell_interactions.pAttackTarget != NULL ) 
+	{
+		Cell* pTarget = pCell->phenotype.cell_interactions.pAttackTarget; 
 
+		pCell->attack_cell(pTarget,dt); 
 
-			if( UniformRandom() < probability || pTarget->phenotype.death.dead ) 
-			{
-				/*
-				std::cout << "*********   *********  ********  attack done **** " << PhysiCell_globals.current_time << " " 
-				<< probability << " "
-				<< "attack time: " << pTarget->state.total_attack_time << " " 		
-				<< "damage: " << pTarget->phenotype.cell_integrity.damage <<  " " 		
-				<< "dead? " << (int) pTarget->phenotype.death.dead << " " 
-				<< "damage delivered: " << pCell->phenotype.cell_interactions.total_damage_delivered << std::endl; 
-				*/
-
-				detach_cells_as_spring(pCell,pTarget); 
-
-				pCell->phenotype.cell_interactions.pAttackTarget = NULL; 
-			} 
+		// probability of ending attack 
+		// end attack if target is dead 
+		double probability = dt / (1e-15 + pCell->phenotype.cell_interactions.attack_duration); 
+		if( proposals.attack_end_draw < probability || pTarget->phenotype.death.dead ) 
+		{
+			detach_cells_as_spring(pCell,pTarget); 
+			pCell->phenotype.cell_interactions.pAttackTarget = NULL; 
 		} 
-
-
-	// move decision if to end attack here. 
-
-
+	} 
+	return; 
 }
 
 void standard_cell_transformations( Cell* pCell, Phenotype& phenotype, double dt )
@@ -1364,7 +1402,7 @@ void standard_cell_transformations( Cell* pCell, Phenotype& phenotype, double dt
 	double probability = 0.0; 
 	for( int i=0 ; i < phenotype.cell_transformations.transformation_rates.size() ; i++ )
 	{
-		probability = phenotype.cell_transformations.transformation_rates[i] * dt;  
+		probability = phenotype.cell_transformations.transformation_rates.read()[i] * dt;  
 		if( UniformRandom() <= probability ) 
 		{
 			// std::cout << "Transforming from " << pCell->type_name << " to " << cell_definitions_by_index[i]->name << std::endl; 
@@ -1450,7 +1488,8 @@ void dynamic_attachments( Cell* pCell , Phenotype& phenotype, double dt )
         {
             // std::string search_string = "adhesive affinity to " + pTest->type_name; 
             // double affinity = get_single_behavior( pCell , search_string );
-			double affinity = phenotype.mechanics.cell_adhesion_affinity(pTest->type_name); 
+			const Mechanics& mechanics = phenotype.mechanics; // const: shared affinities are not copied 
+			double affinity = mechanics.cell_adhesion_affinity(pTest->type_name); 
 
             double prob = attachment_probability * affinity; 
             if( UniformRandom() <= prob )
@@ -1492,7 +1531,8 @@ void dynamic_spring_attachments( Cell* pCell , Phenotype& phenotype, double dt )
         {
             // std::string search_string = "adhesive affinity to " + pTest->type_name; 
             // double affinity = get_single_behavior( pCell , search_string );
-			double affinity = phenotype.mechanics.cell_adhesion_affinity(pTest->type_name); 
+			const Mechanics& mechanics = phenotype.mechanics; // const: shared affinities are not copied 
+			double affinity = mechanics.cell_adhesion_affinity(pTest->type_name); 
 
             double prob = attachment_probability * affinity; 
             if( UniformRandom() <= prob )
@@ -1508,5 +1548,55 @@ void dynamic_spring_attachments( Cell* pCell , Phenotype& phenotype, double dt )
     return; 
 }
 
+void propose_spring_attachment_changes( Cell* pCell , Phenotype& phenotype, double dt , 
+	std::vector<Cell*>& detachments , std::vector<Cell*>& attachments )
+{
+	detachments.clear(); 
+	attachments.clear(); 
+	std::vector<Cell*>& attached = pCell->state.spring_attachments; 
+	
+	// check for detachments 
+	double detachment_probability = phenotype.mechanics.detachment_rate * dt; 
+	for( int j=0; j < attached.size(); j++ )
+	{
+		if( UniformRandom() <= detachment_probability )
+		{ detachments.push_back( attached[j] ); }
+	}
+	
+	// check if I have max number of attachments 
+	int number_of_attachments = attached.size() - detachments.size(); 
+	if( number_of_attachments >= phenotype.mechanics.maximum_number_of_attachments )
+	{ return; }
+	
+	// check for new attachments (same draws as dynamic_spring_attachments) 
+	double attachment_probability = phenotype.mechanics.attachment_rate * dt; 
+	bool done = false; 
+	int j = 0; 
+	while( done == false && j < pCell->state.neighbors.size() )
+	{
+		Cell* pTest = pCell->state.neighbors[j]; 
+		if( pTest->state.spring_attachments.size() < pTest->phenotype.mechanics.maximum_number_of_attachments )
+		{
+			const Mechanics& mechanics = phenotype.mechanics; // const: shared affinities are not copied 
+			double affinity = mechanics.cell_adhesion_affinity(pTest->type_name); 
+			double prob = attachment_probability * affinity; 
+			if( UniformRandom() <= prob )
+			{
+				// only new attachments count towards the maximum 
+				bool attached_now = std::find( attached.begin() , attached.end() , pTest ) != attached.end() 
+					&& std::find( detachments.begin() , detachments.end() , pTest ) == detachments.end(); 
+				if( attached_now == false && std::find( attachments.begin() , attachments.end() , pTest ) == attachments.end() )
+				{
+					attachments.push_back( pTest ); 
+					number_of_attachments++; 
+					if( number_of_attachments >= phenotype.mechanics.maximum_number_of_attachments )
+					{ done = true; }
+				}
+			}
+		}
+		j++; 
+	}
+	return; 
+}
 	
 };
@@ -142,6 +142,23 @@ void evaluate_interactions( Cell* pCell, Phenotype& phenotype, double dt );
 	
 // automated cell phagocytosis, attack, and fusion 
 void standard_cell_cell_interactions( Cell* pCell, Phenotype& phenotype, double dt ); 
+// the same, in two parts: the decisions (random draws, no changes to any cell), then their effects 
+class Cell_Interaction_Proposals
+{
+ public:
+	static const int phagocytosis = 0; 
+	static const int attack = 1; 
+	static const int fusion = 2; 
+	
+	Cell* pCell; 
+	int number_of_actions; // at most one of each kind, in the order decided 
+	int actions[3]; 
+	Cell* targets[3]; 
+	bool attacking; // has an attack target after the actions 
+	double attack_end_draw; 
+}; 
+void propose_cell_cell_interactions( Cell* pCell, Phenotype& phenotype, double dt , Cell_Interaction_Proposals& proposals ); 
+void apply_cell_cell_interactions( Cell_Interaction_Proposals& proposals , double dt ); 
 void standard_cell_transformations( Cell* pCell, Phenotype& phenotype, double dt ); 
 void standard_asymmetric_division_function( Cell* pCell_parent, Cell* pCell_daughter );
 
@@ -150,6 +167,9 @@ void advanced_chemotaxis_function( Cell* pCell, Phenotype& phenotype , double dt
 
 void dynamic_attachments( Cell* pCell , Phenotype& phenotype, double dt ); 
 void dynamic_spring_attachments( Cell* pCell , Phenotype& phenotype, double dt ); 
+// as above, but only reads the attachment lists; the caller applies the changes 
+void propose_spring_attachment_changes( Cell* pCell , Phenotype& phenotype, double dt , 
+	std::vector<Cell*>& detachments , std::vector<Cell*>& attachments ); 
 
 	
 };
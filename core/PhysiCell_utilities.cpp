@@ -145,8 +145,88 @@ double UniformRandom_old_not_thread_safe()
 	return std::generate_canonical<double, 10>(physicell_PRNG_generator);
 }
 
+// Philox4x32-10 (Salmon et al., SC 2011): the four words of counter are replaced by 
+// a random function of (counter, key) 
+void philox4x32( unsigned int* counter , unsigned int key0 , unsigned int key1 )
+{
+	// in locals, so the ten rounds stay in registers 
+	unsigned int c0 = counter[0]; 
+	unsigned int c1 = counter[1]; 
+	unsigned int c2 = counter[2]; 
+	unsigned int c3 = counter[3]; 
+	for( int round=0; round < 10 ; round++ )
+	{
+		unsigned long long p0 = 0xD2511F53ULL * c0; 
+		unsigned long long p1 = 0xCD9E8D57ULL * c2; 
+		c0 = (unsigned int) (p1 >> 32) ^ c1 ^ key0; 
+		c1 = (unsigned int) p1; 
+		c2 = (unsigned int) (p0 >> 32) ^ c3 ^ key1; 
+		c3 = (unsigned int) p0; 
+		key0 += 0x9E3779B9; 
+		key1 += 0xBB67AE85; 
+	}
+	counter[0] = c0; 
+	counter[1] = c1; 
+	counter[2] = c2; 
+	counter[3] = c3; 
+	return; 
+}
+
+// the stream that UniformRandom draws from on this thread, if any. One Philox block 
+// gives two doubles; the second is kept for the next draw. 
+struct Random_Stream
+{
+	bool active; 
+	unsigned int id; 
+	unsigned int site; 
+	unsigned int step; 
+	unsigned int draws; 
+	double next; 
+}; 
+thread_local Random_Stream random_stream = { false , 0 , 0 , 0 , 0 , 0.0 }; 
+
+void set_random_stream( unsigned int id , unsigned int site , unsigned int step )
+{
+	if( PhysiCell_settings.per_cell_random_streams == false )
+	{ return; }
+	Random_Stream& stream = random_stream; 
+	stream.active = true; 
+	stream.id = id; 
+	stream.site = site; 
+	stream.step = step; 
+	stream.draws = 0; 
+	return; 
+}
+
+void clear_random_stream( void )
+{
+	random_stream.active = false; 
+	return; 
+}
+
+double StreamUniformRandom( void )
+{
+	static const double two_to_minus_53 = 1.0 / 9007199254740992.0; 
+	Random_Stream& stream = random_stream; 
+	if( stream.draws % 2 == 1 )
+	{
+		stream.draws++; 
+		return stream.next; 
+	}
+	
+	// 53 random bits for each double 
+	unsigned int words[4] = { stream.draws / 2 , stream.id , stream.site , stream.step }; 
+	philox4x32( words , physicell_random_seed , 0x5043656C ); 
+	stream.draws++; 
+	stream.next = ( ( (unsigned long long) words[2] << 21 ) ^ ( words[3] >> 11 ) ) * two_to_minus_53; 
+	return ( ( (unsigned long long) words[0] << 21 ) ^ ( words[1] >> 11 ) ) * two_to_minus_53; 
+}
+
 double UniformRandom( void )
 {
+	if( random_stream.active )
+	{ return StreamUniformRandom(); }
+	
 	thread_local std::uniform_real_distribution<double> distribution(0.0,1.0);
 	if( local_pnrg_setup_done == false )
 	{
@@ -185,6 +265,15 @@ int UniformInt()
 
 double NormalRandom( double mean, double standard_deviation )
 {
+	if( random_stream.active )
+	{
+		// Box-Muller, so that the draws stay on the stream 
+		static double two_pi = 6.283185307179586476925286766559; 
+		double u1 = 1.0 - StreamUniformRandom(); // (0,1] 
+		double u2 = StreamUniformRandom(); 
+		return mean + standard_deviation * sqrt( -2.0 * log( u1 ) ) * cos( two_pi * u2 ); 
+	}
+	
 	std::normal_distribution<double> d(mean,standard_deviation);
 	return d(physicell_PRNG_generator); 
 }
@@ -194,6 +283,11 @@ double LogNormalRandom( double mean, double standard_deviation )
 	return exp(NormalRandom(log(mean), standard_deviation));
 }
 
+double ExponentialRandom( double rate )
+{
+	return -log( 1.0 - UniformRandom() ) / rate; 
+}
+
 std::vector<double> UniformOnUnitSphere( void )
 {
 	std::vector<double> output = {0,0,0}; 
@@ -89,9 +89,20 @@ void SeedRandom( void );
 
 double UniformRandom( void );
 
+// counter-based random numbers: while a stream is set on a thread, UniformRandom and NormalRandom 
+// return a function of (seed, id, site, step, draw number) there instead of advancing the thread's 
+// generator. Used for per-cell streams (see PhysiCell_settings.per_cell_random_streams). 
+// A stream draw costs more than a draw from the thread's mt19937_64 (each pair of draws takes 
+// one Philox block of ten dependent multiply rounds), so the streams are off by default. 
+void philox4x32( unsigned int* counter , unsigned int key0 , unsigned int key1 ); 
+void set_random_stream( unsigned int id , unsigned int site , unsigned int step ); 
+void clear_random_stream( void ); 
+double StreamUniformRandom( void ); 
+
 int UniformInt( void );
 double NormalRandom( double mean, double standard_deviation );
 double LogNormalRandom( double mean, double standard_deviation );
+double ExponentialRandom( double rate ); 
 
 std::vector<double> UniformOnUnitSphere( void ); 
 std::vector<double> UniformOnUnitCircle( void ); 
@@ -278,6 +278,103 @@ void PhysiCell_Settings::read_from_pugixml( void )
 			PhysiCell_settings.disable_automated_spring_adhesions = true;
 		}
 
+		// <mechanics_neighbor_lists skin="2">true</mechanics_neighbor_lists> 
+		pugi::xml_node node_lists = xml_find_node( node_options , "mechanics_neighbor_lists" ); 
+		if( node_lists && xml_get_my_bool_value( node_lists ) )
+		{
+			PhysiCell_settings.mechanics_neighbor_lists = true; 
+			PhysiCell_settings.mechanics_neighbor_list_skin = node_lists.attribute( "skin" ).as_double( PhysiCell_settings.mechanics_neighbor_list_skin ); 
+			std::cout << "Using mechanics neighbor lists (skin: " << PhysiCell_settings.mechanics_neighbor_list_skin << " " << space_units << ")" << std::endl; 
+		}
+
+		settings = xml_get_bool_value( node_options, "mechanics_pairwise_forces" ); 
+		if( settings )
+		{
+			std::cout << "Evaluating cell-cell mechanics once per pair" << std::endl; 
+			PhysiCell_settings.mechanics_pairwise_forces = true; 
+		}
+
+		settings = xml_get_bool_value( node_options, "mechanics_soa_kernel" ); 
+		if( settings )
+		{
+			std::cout << "Evaluating cell-cell mechanics on a packed snapshot of the cells" << std::endl; 
+			PhysiCell_settings.mechanics_soa_kernel = true; 
+		}
+
+		pugi::xml_node node_sort = xml_find_node( node_options , "spatial_sort_interval" ); 
+		if( node_sort )
+		{
+			PhysiCell_settings.spatial_sort_interval = xml_get_my_int_value( node_sort ); 
+			if( PhysiCell_settings.spatial_sort_interval > 0 )
+			{ std::cout << "Sorting cells in space every " << PhysiCell_settings.spatial_sort_interval << " mechanics steps" << std::endl; }
+		}
+
+		settings = xml_get_bool_value( node_options, "mechanics_rebuild_agent_grid" ); 
+		if( settings )
+		{
+			std::cout << "Rebuilding the mechanics voxel grid after each mechanics step" << std::endl; 
+			PhysiCell_settings.mechanics_rebuild_agent_grid = true; 
+		}
+
+		// <automatic_mechanics_voxel_size regrid_tolerance="0.5">true</automatic_mechanics_voxel_size> 
+		pugi::xml_node node_voxels = xml_find_node( node_options , "automatic_mechanics_voxel_size" ); 
+		if( node_voxels && xml_get_my_bool_value( node_voxels ) )
+		{
+			PhysiCell_settings.automatic_mechanics_voxel_size = true; 
+			PhysiCell_settings.mechanics_voxel_regrid_tolerance = node_voxels.attribute( "regrid_tolerance" ).as_double( PhysiCell_settings.mechanics_voxel_regrid_tolerance ); 
+			std::cout << "Sizing the mechanics voxels automatically (re-grid tolerance: " << PhysiCell_settings.mechanics_voxel_regrid_tolerance << ")" << std::endl; 
+		}
+
+		// <adaptive_mechanics_dt tolerance="0.01" min="0" max="0">true</adaptive_mechanics_dt> 
+		pugi::xml_node node_adaptive = xml_find_node( node_options , "adaptive_mechanics_dt" ); 
+		if( node_adaptive && xml_get_my_bool_value( node_adaptive ) )
+		{
+			PhysiCell_settings.adaptive_mechanics_dt = true; 
+			PhysiCell_settings.mechanics_error_tolerance = node_adaptive.attribute( "tolerance" ).as_double( PhysiCell_settings.mechanics_error_tolerance ); 
+			PhysiCell_settings.mechanics_dt_min = node_adaptive.attribute( "min" ).as_double( PhysiCell_settings.mechanics_dt_min ); 
+			PhysiCell_settings.mechanics_dt_max = node_adaptive.attribute( "max" ).as_double( PhysiCell_settings.mechanics_dt_max ); 
+			std::cout << "Adapting the mechanics time step (error tolerance: " << PhysiCell_settings.mechanics_error_tolerance << " " << space_units << ")" << std::endl; 
+		}
+
+		// <mechanics_sleep speed="0.01" steps="10">true</mechanics_sleep> 
+		pugi::xml_node node_sleep = xml_find_node( node_options , "mechanics_sleep" ); 
+		if( node_sleep && xml_get_my_bool_value( node_sleep ) )
+		{
+			PhysiCell_settings.mechanics_sleep = true; 
+			PhysiCell_settings.mechanics_sleep_speed = node_sleep.attribute( "speed" ).as_double( PhysiCell_settings.mechanics_sleep_speed ); 
+			PhysiCell_settings.mechanics_sleep_steps = node_sleep.attribute( "steps" ).as_int( PhysiCell_settings.mechanics_sleep_steps ); 
+			std::cout << "Letting mechanically settled cells sleep (speed: " << PhysiCell_settings.mechanics_sleep_speed << " " << space_units 
+				<< "/" << time_units << ", steps: " << PhysiCell_settings.mechanics_sleep_steps << ")" << std::endl; 
+		}
+
+		settings = xml_get_bool_value( node_options, "per_cell_random_streams" ); 
+		if( settings )
+		{
+			std::cout << "Using counter-based random streams for each cell" << std::endl; 
+			PhysiCell_settings.per_cell_random_streams = true; 
+		}
+
+		settings = xml_get_bool_value( node_options, "event_driven_phenotype" ); 
+		if( settings )
+		{
+			std::cout << "Scheduling stochastic phase transitions and death by event" << std::endl; 
+			PhysiCell_settings.event_driven_phenotype = true; 
+		}
+
+		settings = xml_get_bool_value( node_options, "batched_division_and_death" ); 
+		if( settings )
+		{
+			std::cout << "Processing cell division and death in batches" << std::endl; 
+			PhysiCell_settings.batched_division_and_death = true; 
+		}
+
+		settings = xml_get_bool_value( node_options, "shared_phenotype_parameters" ); 
+		if( settings )
+		{
+			std::cout << "Sharing per-cell-type phenotype parameters until they are changed" << std::endl; 
+			PhysiCell_settings.shared_phenotype_parameters = true; 
+		}
+
 		pugi::xml_node random_seed_node = xml_find_node(node_options, "random_seed");
 		std::string random_seed = ""; // default is system clock, even if this element is not present
 		if (random_seed_node)
@@ -736,6 +833,24 @@ bool setup_microenvironment_from_XML( pugi::xml_node root_node )
 			xml_get_double_value( node1, "diffusion_coefficient" ); 
 		microenvironment.decay_rates[i] = 
 			xml_get_double_value( node1, "decay_rate" ); 
+		
+		// optionally advance this substrate every n-th diffusion step (by n*diffusion_dt) 
+		pugi::xml_node multiple_node = xml_find_node( node1, "time_step_multiple" ); 
+		if( multiple_node )
+		{ microenvironment.set_diffusion_time_step_multiple( i , xml_get_my_int_value( multiple_node ) ); }
+		
+		// optionally solve for the quasi-steady state instead of the transient 
+		pugi::xml_node qss_node = xml_find_node( node1, "quasi_steady_state" ); 
+		if( qss_node && qss_node.attribute("enabled").as_bool() )
+		{
+			microenvironment.quasi_steady_state_intervals[i] = qss_node.attribute("interval").as_int(1); 
+			microenvironment.quasi_steady_state_source_thresholds[i] = qss_node.attribute("source_change_threshold").as_double(0.0); 
+			if( microenvironment.quasi_steady_state_intervals[i] < 1 )
+			{
+				std::cout << "ERROR: the quasi_steady_state interval for " << name << " must be a positive integer." << std::endl; 
+				exit(-1); 
+			}
+		}
 			
 		// now, get the initial value  
 		node1 = xml_find_node( node, "initial_condition" ); 
@@ -960,6 +1075,35 @@ bool setup_microenvironment_from_XML( pugi::xml_node root_node )
 	default_microenvironment_options.track_internalized_substrates_in_each_agent 
 		= xml_get_bool_value( node, "track_internalized_substrates_in_each_agent" );
 
+	// solve on contiguous (flat, aligned) density storage?
+	pugi::xml_node storage_node = xml_find_node( node , "contiguous_density_storage" );
+	if( storage_node )
+	{
+		default_microenvironment_options.use_contiguous_density_storage = storage_node.attribute("enabled").as_bool();
+		std::string layout = storage_node.attribute("layout").as_string( "substrate_major" );
+		if( layout == "substrate_major" )
+		{ default_microenvironment_options.contiguous_density_layout = substrate_major_density_layout; }
+		else if( layout == "voxel_major" )
+		{ default_microenvironment_options.contiguous_density_layout = voxel_major_density_layout; }
+		else
+		{
+			std::cout << "ERROR: " << layout << " is not a valid contiguous density layout. Use substrate_major or voxel_major." << std::endl;
+			exit(-1);
+		}
+	}
+	
+	// batched SIMD Thomas sweeps in the LOD solvers? (implies substrate-major storage)
+	default_microenvironment_options.vectorized_thomas_solver = xml_get_bool_value( node, "vectorized_thomas_solver" ); 
+	pugi::xml_node vectorized_node = xml_find_node( node , "vectorized_thomas_solver" ); 
+	if( vectorized_node && vectorized_node.attribute("block_size") )
+	{ default_microenvironment_options.thomas_sweep_block_size = vectorized_node.attribute("block_size").as_int(); }
+	
+	// apply bulk sources/sinks in the first sweep of the LOD solver? 
+	default_microenvironment_options.fused_bulk_source_sink = xml_get_bool_value( node, "fused_bulk_source_sink" ); 
+	
+	// update each voxel's secretion/uptake from a single thread (reproducible for any thread count)? 
+	default_microenvironment_options.deterministic_cell_sources_and_sinks = xml_get_bool_value( node, "deterministic_cell_secretion" ); 
+
 	if (argument_parser.path_to_ic_substrate_file != "") {
 		default_microenvironment_options.initial_condition_from_file_enabled = true;
 		std::string file_extension = argument_parser.path_to_ic_substrate_file.substr(argument_parser.path_to_ic_substrate_file.find_last_of(".") + 1);
@@ -116,6 +116,51 @@ class PhysiCell_Settings
 
 	bool disable_automated_spring_adhesions = false; 
 	
+	// mechanics: per-cell neighbor lists, rebuilt when a cell has moved more than half the skin 
+	bool mechanics_neighbor_lists = false; 
+	double mechanics_neighbor_list_skin = 2.0; 
+	// mechanics: evaluate each interacting pair once and apply equal and opposite contributions 
+	bool mechanics_pairwise_forces = false; 
+	// mechanics: run the standard cell-cell forces on a packed (SoA) snapshot of the cells 
+	bool mechanics_soa_kernel = false; 
+	// re-sort all_cells along a Morton (Z-order) curve every this many mechanics steps (0: never) 
+	int spatial_sort_interval = 0; 
+	// rebuild agent_grid by a parallel counting sort after each mechanics step, 
+	// instead of moving cells between voxels one at a time 
+	bool mechanics_rebuild_agent_grid = false; 
+	// size the mechanics voxels from the cells' interaction distances: grow whenever those 
+	// exceed the voxels, shrink when the voxels are larger than needed by more than the 
+	// tolerance (relative; 0: never shrink) 
+	bool automatic_mechanics_voxel_size = false; 
+	double mechanics_voxel_regrid_tolerance = 0.5; 
+	// mechanics: choose each mechanics step from an estimate of the local error of update_position 
+	// (space units per step), between the bounds (0: diffusion_dt and phenotype_dt) 
+	bool adaptive_mechanics_dt = false; 
+	double mechanics_error_tolerance = 0.01; 
+	double mechanics_dt_min = 0.0; 
+	double mechanics_dt_max = 0.0; 
+	// mechanics: cells that stay slower than the speed (and keep their neighbors and size) for this 
+	// many mechanics steps stop updating their velocity and position until something nearby changes 
+	bool mechanics_sleep = false; 
+	double mechanics_sleep_speed = 0.01; 
+	int mechanics_sleep_steps = 10; 
+	
+	// draw each cell's random numbers from a counter-based stream keyed by its ID, the call site 
+	// and the step, so that results do not depend on the number of threads 
+	bool per_cell_random_streams = false; 
+	
+	// stochastic phase transitions and death: draw each event's (unit-rate) hazard once and spend 
+	// it at the current rates, instead of drawing a random number for every rate at every step 
+	bool event_driven_phenotype = false; 
+	
+	// build the daughters of all dividing cells in parallel, and compact all_cells and refill 
+	// agent_grid once per phenotype step, instead of dividing and removing cells one at a time 
+	bool batched_division_and_death = false; 
+	
+	// cells share the per-cell-type parameter vectors (adhesion affinities, interaction and transformation 
+	// rates) with their cell definition and parent, and copy them only when they write to them 
+	bool shared_phenotype_parameters = false; 
+	
 	double SVG_save_interval = 60; 
 	bool enable_SVG_saves = true; 
 
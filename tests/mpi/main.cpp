@@ -0,0 +1,223 @@
+/*
+###############################################################################
+# If you use PhysiCell in your project, please cite PhysiCell and the version #
+# number, such as below:                                                      #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1].    #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# See VERSION.txt or call get_PhysiCell_version() to get the current version  #
+#     x.y.z. Call display_citations() to get detailed information on all cite-#
+#     able software used in your PhysiCell application.                       #
+#                                                                             #
+# Because PhysiCell extensively uses BioFVM, we suggest you also cite BioFVM  #
+#     as below:                                                               #
+#                                                                             #
+# We implemented and solved the model using PhysiCell (Version x.y.z) [1],    #
+# with BioFVM [2] to solve the transport equations.                           #
+#                                                                             #
+# [1] A Ghaffarizadeh, R Heiland, SH Friedman, SM Mumenthaler, and P Macklin, #
+#     PhysiCell: an Open Source Physics-Based Cell Simulator for Multicellu-  #
+#     lar Systems, PLoS Comput. Biol. 14(2): e1005991, 2018                   #
+#     DOI: 10.1371/journal.pcbi.1005991                                       #
+#                                                                             #
+# [2] A Ghaffarizadeh, SH Friedman, and P Macklin, BioFVM: an efficient para- #
+#     llelized diffusive transport solver for 3-D biological simulations,     #
+#     Bioinformatics 32(8): 1256-8, 2016. DOI: 10.1093/bioinformatics/btv730  #
+#                                                                             #
+###############################################################################
+#                                                                             #
+# BSD 3-Clause License (see https://opensource.org/licenses/BSD-3-Clause)     #
+#                                                                             #
+# Copyright (c) 2015-2018, Paul Macklin and the PhysiCell Project             #
+# All rights reserved.                                                        #
+#                                                                             #
+# Redistribution and use in source and binary forms, with or without          #
+# modification, are permitted provided that the following conditions are met: #
+#                                                                             #
+# 1. Redistributions of source code must retain the above copyright notice,   #
+# this list of conditions and the following disclaimer.                       #
+#                                                                             #
+# 2. Redistributions in binary form must reproduce the above copyright        #
+# notice, this list of conditions and the following disclaimer in the         #
+# documentation and/or other materials provided with the distribution.        #
+#                                                                             #
+# 3. Neither the name of the copyright holder nor the names of its            #
+# contributors may be used to endorse or promote products derived from this   #
+# software without specific prior written permission.                         #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" #
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE   #
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE  #
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE   #
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR         #
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF        #
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS    #
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN     #
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)     #
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE  #
+# POSSIBILITY OF SUCH DAMAGE.                                                 #
+#                                                                             #
+###############################################################################
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+#include "../../BioFVM/BioFVM.h"
+#include "../../BioFVM/BioFVM_mpi.h"
+
+using namespace BioFVM; 
+
+// domain and substrates shared by the serial and distributed runs 
+double x_min = -300, x_max = 300, y_min = -250, y_max = 250, z_min = -200, z_max = 200; 
+double h = 20.0; 
+
+void setup_substrates( Microenvironment& M )
+{
+	M.set_density( 0 , "oxygen" , "mmHg" ); 
+	M.add_density( "signal" , "dimensionless" ); 
+	M.diffusion_coefficients[0] = 1e5; 
+	M.decay_rates[0] = 0.1; 
+	M.diffusion_coefficients[1] = 1e3; 
+	M.decay_rates[1] = 0.01; 
+	return; 
+}
+
+// smooth initial data and Dirichlet conditions for oxygen on the outer boundary 
+void setup_initial_conditions( Microenvironment& M , bool distributed )
+{
+	std::vector<double> dirichlet_values( 2 , 38.0 ); 
+	for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+	{
+		std::vector<double>& center = M.voxels(n).center; 
+		M.density_vector(n)[0] = 10.0 + 5.0*sin( 0.01*center[0] ) * cos( 0.02*center[2] ); 
+		M.density_vector(n)[1] = exp( -0.0001*( center[0]*center[0] + center[1]*center[1] + (center[2]-50)*(center[2]-50) ) ); 
+		
+		bool outer; 
+		if( distributed )
+		{ outer = mpi_voxel_on_outer_boundary( M , n ); }
+		else
+		{
+			std::vector<unsigned int> ijk = M.cartesian_indices( n ); 
+			outer = ijk[0] == 0 || ijk[0] == M.mesh.x_coordinates.size()-1 || ijk[1] == 0 || 
+				ijk[1] == M.mesh.y_coordinates.size()-1 || ijk[2] == 0 || ijk[2] == M.mesh.z_coordinates.size()-1; 
+		}
+		if( outer )
+		{ M.add_dirichlet_node( n , dirichlet_values ); }
+	}
+	M.set_substrate_dirichlet_activation( 0 , true ); 
+	M.set_substrate_dirichlet_activation( 1 , false ); 
+	return; 
+}
+
+int main( int argc, char* argv[] )
+{
+	MPI_Init( &argc , &argv ); 
+	int rank; 
+	int size; 
+	MPI_Comm_rank( MPI_COMM_WORLD , &rank ); 
+	MPI_Comm_size( MPI_COMM_WORLD , &size ); 
+	
+	int steps = 20; 
+	if( argc > 1 )
+	{ steps = atoi( argv[1] ); }
+	double dt = 0.01; 
+	
+	// distributed run 
+	
+	Microenvironment M; 
+	setup_substrates( M ); 
+	setup_mpi_slab_decomposition( M , MPI_COMM_WORLD , x_min, x_max, y_min, y_max, z_min, z_max, h, h, h ); 
+	setup_initial_conditions( M , true ); 
+	
+	double start = MPI_Wtime(); 
+	for( int i=0; i < steps ; i++ )
+	{ M.simulate_diffusion_decay( dt ); }
+	double distributed_time = MPI_Wtime() - start; 
+	compute_all_gradient_vectors_mpi( M ); 
+	
+	std::vector<double> distributed_densities; 
+	gather_densities_mpi( M , distributed_densities , 0 ); 
+	
+	// the z-gradients of each rank's first plane, for comparison on rank 0 
+	int plane = M.mesh.x_coordinates.size() * M.mesh.y_coordinates.size(); 
+	std::vector<double> local_gradients( plane * 2 ); 
+	for( int m=0; m < plane ; m++ )
+	{
+		local_gradients[2*m] = M.gradient_vector( m )[0][2]; 
+		local_gradients[2*m+1] = M.gradient_vector( m )[1][2]; 
+	}
+	std::vector<double> first_plane_gradients; 
+	if( rank == 0 )
+	{ first_plane_gradients.resize( plane * 2 * size ); }
+	MPI_Gather( local_gradients.data() , plane*2 , MPI_DOUBLE , first_plane_gradients.data() , plane*2 , MPI_DOUBLE , 0 , MPI_COMM_WORLD ); 
+	
+	int failed = 0; 
+	if( rank == 0 )
+	{
+		// serial reference on the whole mesh 
+		
+		Microenvironment S; 
+		setup_substrates( S ); 
+		S.resize_space( x_min, x_max, y_min, y_max, z_min, z_max, h, h, h ); 
+		S.diffusion_decay_solver = diffusion_decay_solver__constant_coefficients_LOD_3D; 
+		setup_initial_conditions( S , false ); 
+		
+		start = MPI_Wtime(); 
+		for( int i=0; i < steps ; i++ )
+		{ S.simulate_diffusion_decay( dt ); }
+		double serial_time = MPI_Wtime() - start; 
+		S.compute_all_gradient_vectors(); 
+		
+		double max_difference = 0.0; 
+		double max_value = 0.0; 
+		for( unsigned int n=0; n < S.number_of_voxels() ; n++ )
+		{
+			for( int q=0; q < 2 ; q++ )
+			{
+				max_difference = std::max( max_difference , fabs( S.density_vector(n)[q] - distributed_densities[2*n+q] ) ); 
+				max_value = std::max( max_value , fabs( S.density_vector(n)[q] ) ); 
+			}
+		}
+		
+		double max_gradient_difference = 0.0; 
+		for( int r=0; r < size ; r++ )
+		{
+			int first_plane = mpi_slab_decomposition.z_slab_start[r]; 
+			for( int m=0; m < plane ; m++ )
+			{
+				for( int q=0; q < 2 ; q++ )
+				{
+					double serial_gradient = S.gradient_vector( m + first_plane*plane )[q][2]; 
+					max_gradient_difference = std::max( max_gradient_difference , 
+						fabs( serial_gradient - first_plane_gradients[ (r*plane+m)*2 + q ] ) ); 
+				}
+			}
+		}
+		
+		double tolerance = 1e-12 * max_value; 
+		std::cout << "ranks: " << size << " mesh: " << S.mesh.x_coordinates.size() << " x " << S.mesh.y_coordinates.size() 
+			<< " x " << S.mesh.z_coordinates.size() << " steps: " << steps << std::endl; 
+		std::cout << "max |serial - distributed| density: " << max_difference 
+			<< " z-gradient on slab faces: " << max_gradient_difference << std::endl; 
+		std::cout << "serial time: " << serial_time << " s distributed time: " << distributed_time << " s" << std::endl; 
+		if( max_difference > tolerance || max_gradient_difference > tolerance / h )
+		{
+			std::cout << "FAILED" << std::endl; 
+			failed = 1; 
+		}
+		else
+		{ std::cout << "PASSED" << std::endl; }
+	}
+	
+	MPI_Bcast( &failed , 1 , MPI_INT , 0 , MPI_COMM_WORLD ); 
+	MPI_Finalize(); 
+	return failed; 
+}
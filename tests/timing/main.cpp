@@ -69,6 +69,8 @@
 #include <string>
 #include <random>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
 
 #include "PhysiCell_standard_models.h" 
 #include "PhysiCell_cell.h" 
@@ -130,10 +132,130 @@ int time_custom_vars1()
     return 1;
 }
 
-int main()
+// time the LOD Thomas sweeps on n^3 meshes (one substrate) for the scalar, 
+// vectorized, and vectorized + cache-blocked sweeps. Bandwidth counts one read 
+// and one write per voxel for each forward and backward pass of the 3 sweeps. 
+int time_thomas_sweeps( int max_mesh_size )
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    int nsteps = 5; 
+    double dt = 0.01; 
+
+    for( int n=100; n <= max_mesh_size; n += 100 )
+    {
+        BioFVM::Microenvironment M; 
+        M.set_density( 0 , "substrate" , "dimensionless" , 1e5 , 0.1 ); 
+        M.resize_space_uniform( 0.0 , 20.0*n , 0.0 , 20.0*n , 0.0 , 20.0*n , 20.0 ); 
+        M.diffusion_decay_solver = BioFVM::diffusion_decay_solver__constant_coefficients_LOD_3D; 
+        for( unsigned int i=0; i < M.number_of_voxels() ; i++ )
+        { M.density_vector(i)[0] = (double) (i % 97); }
+
+        double voxels = (double) M.number_of_voxels(); 
+        std::cout << "mesh " << n << "^3 (" << voxels << " voxels)" << std::endl;
+
+        const char* names[4] = { "per-voxel vectors" , "contiguous, scalar" , "contiguous, vectorized" , "contiguous, vectorized, blocked" }; 
+        for( int mode=0; mode < 4; mode++ )
+        {
+            if( mode == 0 )
+            { M.disable_contiguous_density_storage(); }
+            else
+            { M.enable_contiguous_density_storage( BioFVM::substrate_major_density_layout ); }
+            M.enable_vectorized_thomas_sweeps( mode >= 2 ); 
+            M.set_thomas_sweep_block_size( mode == 3 ? 64 : 0 ); 
+            M.simulate_diffusion_decay( dt ); // setup and warm-up 
+
+            auto start = std::chrono::steady_clock::now();
+            for( int step=0; step < nsteps; step++ )
+            { M.simulate_diffusion_decay( dt ); }
+            auto end = std::chrono::steady_clock::now();
+            double step_ms = std::chrono::duration<double,std::milli>(end - start).count() / nsteps; 
+            double bandwidth = 3*2*2*8*voxels / (step_ms*1e-3) / 1e9; 
+            std::cout << "  " << names[mode] << " : " << step_ms << " ms per step, " 
+                << bandwidth << " GB/s" << std::endl;
+        }
+    }
+    return 1;
+}
+
+// time the mechanics velocity update on a confluent monolayer whose cells are in random 
+// (birth-like) order in all_cells, then again after a Morton sort of all_cells 
+int time_spatial_sort( int number_of_cells )
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    int nsteps = 10; 
+    double dt = 0.1; 
+
+    // hexagonal packing at the default cell diameter 
+    double spacing = 16.8; 
+    int side = (int) ceil( sqrt( (double) number_of_cells ) ); 
+    double width = spacing * ( side + 2 ); 
+    microenvironment.resize_space( -10.0 , width , -10.0 , width , -10.0 , 10.0 , 20.0 , 20.0 , 20.0 ); 
+    PhysiCell::Cell_Container* cell_container = PhysiCell::create_cell_container_for_microenvironment( microenvironment, 30.0 );
+
+    PhysiCell::initialize_default_cell_definition(); 
+    PhysiCell::build_cell_definitions_maps(); 
+    PhysiCell::cell_defaults.phenotype.mechanics.sync_to_cell_definitions(); 
+
+    std::vector<int> order( side*side ); 
+    for( int n=0; n < side*side ; n++ )
+    { order[n] = n; }
+    std::mt19937 gen( 0 ); 
+    std::shuffle( order.begin() , order.end() , gen ); 
+    for( int n=0; n < number_of_cells ; n++ )
+    {
+        int i = order[n] % side; 
+        int j = order[n] / side; 
+        PhysiCell::Cell* pCell = PhysiCell::create_cell(); 
+        pCell->assign_position( spacing*( i + 0.5*(j%2) ) , spacing*j*0.866 , 0.0 ); 
+    }
+    std::cout << "ncells = " << PhysiCell::all_cells->size() << std::endl;
+
+    for( int sorted=0; sorted < 2 ; sorted++ )
+    {
+        if( sorted )
+        { cell_container->sort_cells_spatially(); }
+
+        auto start = std::chrono::steady_clock::now();
+        for( int step=0; step < nsteps ; step++ )
+        {
+            #pragma omp parallel for 
+            for( int i=0; i < PhysiCell::all_cells->size(); i++ )
+            {
+                PhysiCell::Cell* pC = (*PhysiCell::all_cells)[i]; 
+                PhysiCell::standard_update_cell_velocity( pC , pC->phenotype , dt ); 
+                pC->velocity.assign( 3 , 0.0 ); 
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "  velocity update, " << ( sorted ? "Morton order" : "random order" ) << " : " 
+            << std::chrono::duration<double,std::milli>(end - start).count() / nsteps << " ms per step" << std::endl;
+    }
+
+    // leave an empty single-voxel domain for the other tests 
+    while( PhysiCell::all_cells->size() > 0 )
+    { PhysiCell::delete_cell( (int) PhysiCell::all_cells->size() - 1 ); }
+    microenvironment.resize_space( 1 , 1 , 1 ); 
+    return 1;
+}
+
+int main( int argc, char* argv[] )
 {
     std::cout << ">>>>>>>>>  Timing tests" << std::endl;
+    PhysiCell::SeedRandom( 0 ); // create_cell draws random orientations 
+
+    // cells for the spatial sort benchmark (run first: it needs its own domain) 
+    int sort_cells = 1000000; 
+    if( argc > 2 )
+    { sort_cells = atoi( argv[2] ); }
+    time_spatial_sort( sort_cells );
+
     time_custom_vars1();
 
+    // largest mesh for the sweep benchmark (400^3 needs tens of GB of memory)
+    int max_mesh_size = 400; 
+    if( argc > 1 )
+    { max_mesh_size = atoi( argv[1] ); }
+    time_thomas_sweeps( max_mesh_size );
+
     return 1;
 }
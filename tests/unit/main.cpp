@@ -69,6 +69,7 @@
 #include <string>
 #include "PhysiCell_standard_models.h" 
 #include "PhysiCell_cell.h" 
+#include "PhysiCell_cell_container.h" 
 
 //using namespace PhysiCell;   // bad practice
 
@@ -96,10 +97,273 @@ int custom_vars1()
     return 1;
 }
 
+int counter_random_streams()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    // known answer for Philox4x32-10 with a zero counter and key (Random123) 
+    unsigned int counter[4] = {0,0,0,0}; 
+    PhysiCell::philox4x32( counter , 0 , 0 ); 
+    bool passed = counter[0] == 0x6627e8d5 && counter[1] == 0xe169c58d 
+        && counter[2] == 0xbc57ac4c && counter[3] == 0x9b00dbd8; 
+    std::cout << "Philox4x32-10 known answer: " << (passed ? "PASS" : "FAIL") << std::endl;
+
+    // the same (id, site, step) gives the same draws, whatever was drawn in between 
+    PhysiCell::PhysiCell_settings.per_cell_random_streams = true; 
+    double draws[3]; 
+    double sum = 0.0; 
+    PhysiCell::set_random_stream( 42 , 1 , 7 ); 
+    for( int n=0; n < 3 ; n++ )
+    { draws[n] = PhysiCell::UniformRandom(); }
+    PhysiCell::set_random_stream( 43 , 1 , 7 ); 
+    for( int n=0; n < 100000 ; n++ )
+    { sum += PhysiCell::UniformRandom(); }
+    PhysiCell::set_random_stream( 42 , 1 , 7 ); 
+    bool repeated = true; 
+    for( int n=0; n < 3 ; n++ )
+    { repeated = repeated && PhysiCell::UniformRandom() == draws[n]; }
+    PhysiCell::clear_random_stream(); 
+    PhysiCell::PhysiCell_settings.per_cell_random_streams = false; 
+    std::cout << "repeated stream: " << (repeated ? "PASS" : "FAIL") << std::endl;
+    std::cout << "mean of 1e5 draws: " << sum / 100000.0 << std::endl;
+
+    return passed && repeated && fabs( sum / 100000.0 - 0.5 ) < 0.01; 
+}
+
+// solve the same small problem (two substrates, Dirichlet nodes, mesh sizes that are 
+// not multiples of the SIMD width) on the per-voxel vectors and on the flattened 
+// storage; the LOD sweeps do the same arithmetic, so the results must match exactly 
+int flattened_diffusion_solve()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    bool passed = true; 
+    for( int dimensions=2; dimensions <= 3 ; dimensions++ )
+    {
+        // 0: per-voxel vectors, 1: voxel-major, 2: substrate-major, 3: vectorized, 4: vectorized and blocked 
+        std::vector< std::vector<double> > results[5]; 
+        for( int mode=0; mode < 5 ; mode++ )
+        {
+            BioFVM::Microenvironment M; 
+            M.set_density( 0 , "oxygen" , "mmHg" , 1e5 , 0.1 ); 
+            M.add_density( "drug" , "dimensionless" , 1e3 , 0.01 ); 
+            M.resize_space_uniform( 0.0 , 260.0 , 0.0 , 180.0 , 0.0 , dimensions == 3 ? 140.0 : 20.0 , 20.0 ); 
+            if( dimensions == 3 )
+            { M.diffusion_decay_solver = BioFVM::diffusion_decay_solver__constant_coefficients_LOD_3D; }
+            else
+            { M.diffusion_decay_solver = BioFVM::diffusion_decay_solver__constant_coefficients_LOD_2D; }
+            for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+            {
+                M.density_vector(n)[0] = (double) (n % 97); 
+                M.density_vector(n)[1] = (double) (n % 13) * 0.5; 
+            }
+            std::vector<double> boundary( 2 , 38.0 ); 
+            for( unsigned int n=0; n < M.number_of_voxels() ; n += 17 )
+            { M.add_dirichlet_node( n , boundary ); }
+            M.set_substrate_dirichlet_activation( 0 , true ); 
+
+            if( mode == 1 )
+            { M.enable_contiguous_density_storage( BioFVM::voxel_major_density_layout ); }
+            if( mode == 2 )
+            { M.enable_contiguous_density_storage( BioFVM::substrate_major_density_layout ); }
+            if( mode >= 3 )
+            { M.enable_vectorized_thomas_sweeps( true ); }
+            if( mode == 4 )
+            { M.set_thomas_sweep_block_size( 4 ); }
+
+            for( int step=0; step < 10 ; step++ )
+            { M.simulate_diffusion_decay( 0.01 ); }
+            for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+            { results[mode].push_back( M.density_vector(n) ); }
+        }
+        for( int mode=1; mode < 5 ; mode++ )
+        {
+            bool same = results[mode] == results[0]; 
+            std::cout << dimensions << "-D, mode " << mode << " matches the per-voxel solve: " << (same ? "PASS" : "FAIL") << std::endl;
+            passed = passed && same; 
+        }
+    }
+    return passed; 
+}
+
+// the quasi-steady-state solve of a substrate with decay, bulk uptake, and a Dirichlet 
+// face should match the field a long transient LOD solve settles to 
+void qss_uptake( BioFVM::Microenvironment* , int voxel_index , std::vector<double>* write_here )
+{ (*write_here)[0] = ( voxel_index % 7 == 0 ) ? 0.5 : 0.0; }
+
+int quasi_steady_state_vs_transient()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    std::vector< std::vector<double> > results[2]; 
+    for( int mode=0; mode < 2 ; mode++ )
+    {
+        BioFVM::Microenvironment M; 
+        M.set_density( 0 , "oxygen" , "mmHg" , 1e3 , 0.1 ); 
+        M.resize_space_uniform( 0.0 , 200.0 , 0.0 , 160.0 , 0.0 , 120.0 , 20.0 ); 
+        M.diffusion_decay_solver = BioFVM::diffusion_decay_solver__constant_coefficients_LOD_3D; 
+        M.bulk_uptake_rate_function = qss_uptake; 
+        std::vector<double> boundary( 1 , 38.0 ); 
+        for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+        {
+            if( M.mesh.voxels[n].center[0] < 20.0 )
+            { M.add_dirichlet_node( n , boundary ); }
+        }
+        M.set_substrate_dirichlet_activation( 0 , true ); 
+        
+        if( mode == 0 )
+        {
+            // transient: 200 min, long enough for the slowest mode to decay. The 
+            // operator splitting error is first order in dt. 
+            for( int step=0; step < 40000 ; step++ )
+            {
+                M.simulate_bulk_sources_and_sinks( 0.005 ); 
+                M.simulate_diffusion_decay( 0.005 ); 
+            }
+        }
+        else
+        {
+            M.quasi_steady_state_intervals[0] = 1; 
+            M.auto_choose_diffusion_decay_solver(); 
+            M.simulate_bulk_sources_and_sinks( 0.01 ); 
+            M.simulate_diffusion_decay( 0.01 ); 
+        }
+        for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+        { results[mode].push_back( M.density_vector(n) ); }
+    }
+    
+    double max_difference = 0.0; 
+    for( unsigned int n=0; n < results[0].size() ; n++ )
+    { max_difference = std::max( max_difference , fabs( results[1][n][0] - results[0][n][0] ) ); }
+    bool passed = max_difference < 0.01 * 38.0; 
+    std::cout << "max difference to the transient solve: " << max_difference << " " << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed; 
+}
+
+// custom bulk rates that were cached with update_rates() are fused into the first LOD 
+// sweep (simulate_bulk_sources_and_sinks leaves the densities alone), with the same result 
+// as the unfused update; reassigning a rate function goes back to the unfused update 
+void fused_supply( BioFVM::Microenvironment* , int voxel_index , std::vector<double>* write_here )
+{ (*write_here)[0] = 0.01 * ( voxel_index % 5 ); (*write_here)[1] = 0.02; }
+void fused_target( BioFVM::Microenvironment* , int voxel_index , std::vector<double>* write_here )
+{ (*write_here)[0] = 20.0; (*write_here)[1] = 1.0 + ( voxel_index % 3 ); }
+void fused_uptake( BioFVM::Microenvironment* , int voxel_index , std::vector<double>* write_here )
+{ (*write_here)[0] = ( voxel_index % 7 == 0 ) ? 0.5 : 0.0; (*write_here)[1] = 0.001; }
+
+int fused_bulk_source_sink()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    std::vector< std::vector<double> > results[2]; 
+    bool deferred = true; 
+    bool unfused_after_reassignment = true; 
+    for( int mode=0; mode < 2 ; mode++ )
+    {
+        BioFVM::Microenvironment M; 
+        M.set_density( 0 , "oxygen" , "mmHg" , 1e3 , 0.1 ); 
+        M.add_density( "drug" , "dimensionless" , 1e2 , 0.01 ); 
+        M.resize_space_uniform( 0.0 , 200.0 , 0.0 , 160.0 , 0.0 , 120.0 , 20.0 ); 
+        M.diffusion_decay_solver = BioFVM::diffusion_decay_solver__constant_coefficients_LOD_3D; 
+        M.bulk_supply_rate_function = fused_supply; 
+        M.bulk_supply_target_densities_function = fused_target; 
+        M.bulk_uptake_rate_function = fused_uptake; 
+        for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+        {
+            M.density_vector(n)[0] = (double) (n % 11); 
+            M.density_vector(n)[1] = 2.0; 
+        }
+        if( mode == 1 )
+        {
+            M.update_rates(); 
+            M.enable_fused_bulk_source_sink( true ); 
+        }
+        
+        for( int step=0; step < 10 ; step++ )
+        {
+            std::vector<double> before = M.density_vector(1); 
+            M.simulate_bulk_sources_and_sinks( 0.01 ); 
+            if( mode == 1 )
+            { deferred = deferred && M.density_vector(1) == before; }
+            M.simulate_diffusion_decay( 0.01 ); 
+        }
+        for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+        { results[mode].push_back( M.density_vector(n) ); }
+        
+        if( mode == 1 )
+        {
+            M.bulk_supply_rate_function = fused_uptake; 
+            std::vector<double> before = M.density_vector(1); 
+            M.simulate_bulk_sources_and_sinks( 0.01 ); 
+            unfused_after_reassignment = M.density_vector(1) != before; 
+        }
+    }
+    
+    double max_difference = 0.0; 
+    for( unsigned int n=0; n < results[0].size() ; n++ )
+    {
+        for( unsigned int q=0; q < results[0][n].size() ; q++ )
+        { max_difference = std::max( max_difference , fabs( results[1][n][q] - results[0][n][q] ) ); }
+    }
+    bool passed = deferred && unfused_after_reassignment && max_difference < 1e-12; 
+    std::cout << "fused into the solve: " << (deferred ? "yes" : "no") 
+        << ", max difference to the unfused update: " << max_difference 
+        << ", unfused after reassignment: " << (unfused_after_reassignment ? "yes" : "no") 
+        << " " << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed; 
+}
+
+// a cell's uptake of a quasi-steady substrate is part of the solve, so the cell update 
+// must leave the solved field in the cell's voxel as it is 
+int quasi_steady_state_cell_uptake()
+{
+    std::cout << "--------------  " << __FUNCTION__ << " -------------- " << std::endl;
+    PhysiCell::SeedRandom( 0 ); 
+    BioFVM::Microenvironment& M = BioFVM::microenvironment; 
+    M.set_density( 0 , "oxygen" , "mmHg" , 1e3 , 0.1 ); 
+    M.resize_space_uniform( 0.0 , 200.0 , 0.0 , 160.0 , 0.0 , 120.0 , 20.0 ); 
+    std::vector<double> boundary( 1 , 38.0 ); 
+    for( unsigned int n=0; n < M.number_of_voxels() ; n++ )
+    {
+        if( M.mesh.voxels[n].center[0] < 20.0 )
+        { M.add_dirichlet_node( n , boundary ); }
+    }
+    M.set_substrate_dirichlet_activation( 0 , true ); 
+    M.quasi_steady_state_intervals[0] = 1; 
+    M.auto_choose_diffusion_decay_solver(); 
+    
+    PhysiCell::Cell_Container* pContainer = PhysiCell::create_cell_container_for_microenvironment( M , 30.0 ); 
+    PhysiCell::build_cell_definitions_maps(); 
+    PhysiCell::setup_signal_behavior_dictionaries(); 
+    PhysiCell::Cell* pCell = PhysiCell::create_cell(); 
+    pCell->assign_position( 110.0 , 90.0 , 50.0 ); 
+    pCell->phenotype.secretion.sync_to_microenvironment( &M ); 
+    pCell->phenotype.secretion.set_advancer( &PhysiCell::Secretion::default_advancer ); 
+    pCell->phenotype.secretion.uptake_rates[0] = 10.0; 
+    int n = pCell->get_current_voxel_index(); 
+    
+    // the first cell update hands the cell's rates to BioFVM, so the second solve includes them 
+    M.simulate_diffusion_decay( 0.01 ); 
+    double without_cell = M.density_vector(n)[0]; 
+    pContainer->update_all_cells( 0.0 , 6.0 , 0.1 , 0.01 ); 
+    M.simulate_diffusion_decay( 0.01 ); 
+    double solved = M.density_vector(n)[0]; 
+    pContainer->update_all_cells( 0.01 , 6.0 , 0.1 , 0.01 ); 
+    double updated = M.density_vector(n)[0]; 
+    
+    bool passed = updated == solved && solved < without_cell; 
+    std::cout << "voxel value after the cell update: " << updated << " (solved: " << solved << ") " 
+        << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed; 
+}
+
 int main()
 {
     std::cout << ">>>>>>>>>  Unit tests" << std::endl;
-    custom_vars1();
+    // each test returns 1 if it passed 
+    int failures = 0; 
+    failures += !custom_vars1();
+    failures += !counter_random_streams();
+    failures += !flattened_diffusion_solve();
+    failures += !quasi_steady_state_vs_transient();
+    failures += !quasi_steady_state_cell_uptake();
+    failures += !fused_bulk_source_sink();
 
-    return 1;
+    std::cout << ">>>>>>>>>  " << failures << " failed" << std::endl;
+    return failures;
 }
\ No newline at end of file